@@ -1,8 +1,12 @@
 #pragma once
 
+#include "OthelloFwd.hpp"
+#include "SearchLimits.hpp"
+#include <stop_token>
 #include <utility>
+#include <vector>
 
-class Othello;
+struct MoveScore;
 
 class AI {
 public:
@@ -10,5 +14,41 @@ public:
 
   virtual Move go(const Othello &othello) = 0;
 
+  /**
+   * Searches within the given limits as well as the AI's own, and reports
+   * its progress to them. AIs that cannot stop early ignore them.
+   * @param othello
+   * @param limits
+   * @return
+   */
+  virtual Move go(const Othello &othello, const SearchLimits &) {
+    return go(othello);
+  }
+
+  /**
+   * Thinks about the position while the opponent is to move, until a stop
+   * is requested, so that go has less left to do once the opponent moved.
+   * Never runs at the same time as go. AIs that learn nothing from it
+   * return right away.
+   * @param othello
+   * @param stopToken
+   */
+  virtual void ponder(const Othello &, std::stop_token) {}
+
+  /**
+   * Scores every legal move of the position instead of only picking the
+   * best, within the given limits as well as the AI's own
+   * @param othello
+   * @param limits
+   * @param margin Moves scoring more than this below the best only get an
+   * upper bound, which takes far less searching than an exact score.
+   * Infinity scores every move exactly.
+   * @return The moves best first, none from AIs that cannot tell how good
+   * a move is
+   */
+  virtual std::vector<MoveScore> analyze(const Othello &othello,
+                                         const SearchLimits &limits,
+                                         double margin);
+
   virtual ~AI() = default;
 };
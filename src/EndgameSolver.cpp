@@ -0,0 +1,421 @@
+#include "EndgameSolver.hpp"
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace {
+constexpr int N = Othello::boardSize;
+using Bitboard = Othello::Bitboard;
+using Geometry = bitboard::Geometry<N>;
+
+/** Above every score, a game ends with at most N * N discs on the board */
+constexpr int infinity = N * N + 1;
+
+/**
+ * From this many empty squares on, moves are tried fastest first: the ones
+ * that leave the opponent the fewest replies go first. Below it, counting
+ * replies costs more than it saves.
+ */
+constexpr int fastestFirstEmpties = 7;
+
+/** Positions with fewer empty squares are cheaper to search than to look up */
+constexpr int tableEmpties = 8;
+
+/** The table holds 2^20 entries, about 24 MB */
+constexpr int tableBits = 20;
+
+/** How many nodes go by between two looks at the clock */
+constexpr std::uint64_t checkInterval = 4096;
+
+constexpr Bitboard bit(int square) { return Bitboard{1} << square; }
+
+/**
+ * The squares of each quadrant. Moving into a quadrant with an odd number of
+ * empty squares tends to leave the last move there to us, so those moves go
+ * first.
+ */
+constexpr std::array<Bitboard, 4> quadrants{
+    Geometry::squaresWhere([](int x, int y) { return x < N / 2 && y < N / 2; }),
+    Geometry::squaresWhere(
+        [](int x, int y) { return x >= N / 2 && y < N / 2; }),
+    Geometry::squaresWhere(
+        [](int x, int y) { return x < N / 2 && y >= N / 2; }),
+    Geometry::squaresWhere(
+        [](int x, int y) { return x >= N / 2 && y >= N / 2; })};
+
+/**
+ * @return The empty squares that are in a quadrant with an odd number of them
+ */
+Bitboard oddQuadrants(Bitboard empty) {
+  Bitboard odd = 0;
+  for (const Bitboard quadrant : quadrants)
+    if (bitboard::popcount(empty & quadrant) % 2)
+      odd |= empty & quadrant;
+  return odd;
+}
+
+/**
+ * The lines through the board in one direction, each as a mask
+ */
+template <int Count, class Index>
+constexpr std::array<Bitboard, Count> linesBy(Index index) {
+  std::array<Bitboard, Count> lines{};
+  for (int y = 0; y < N; ++y)
+    for (int x = 0; x < N; ++x)
+      lines[index(x, y)] |= bit(bitboard::square<N>(x, y));
+  return lines;
+}
+
+constexpr auto rows = linesBy<N>([](int, int y) { return y; });
+constexpr auto columns = linesBy<N>([](int x, int) { return x; });
+constexpr auto diagonals =
+    linesBy<2 * N - 1>([](int x, int y) { return x - y + N - 1; });
+constexpr auto antiDiagonals =
+    linesBy<2 * N - 1>([](int x, int y) { return x + y; });
+
+template <std::size_t Count>
+Bitboard fullLines(const std::array<Bitboard, Count> &lines, Bitboard filled) {
+  Bitboard full = 0;
+  for (const Bitboard line : lines)
+    if ((filled & line) == line)
+      full |= line;
+  return full;
+}
+
+/**
+ * Finds discs that can never flip: along each of the four axes the disc has
+ * to be in a full line, at the edge, or next to another such disc of its
+ * own colour
+ * @param discs The discs of one side
+ * @param filled The discs of both sides
+ * @return Some of the stable discs, not necessarily all of them
+ */
+Bitboard stableDiscs(Bitboard discs, Bitboard filled) {
+  constexpr Bitboard firstColumn = columns.front();
+  constexpr Bitboard lastColumn = columns.back();
+  constexpr Bitboard sides = firstColumn | lastColumn;
+  constexpr Bitboard ends = rows.front() | rows.back();
+  const Bitboard horizontal = fullLines(rows, filled) | sides;
+  const Bitboard vertical = fullLines(columns, filled) | ends;
+  const Bitboard diagonal = fullLines(diagonals, filled) | Geometry::edges;
+  const Bitboard antiDiagonal =
+      fullLines(antiDiagonals, filled) | Geometry::edges;
+
+  Bitboard stable = 0;
+  while (true) {
+    const Bitboard next =
+        discs &
+        (horizontal | (stable << 1 & ~firstColumn) |
+         (stable >> 1 & ~lastColumn)) &
+        (vertical | stable << N | stable >> N) &
+        (diagonal | (stable << (N + 1) & ~firstColumn) |
+         (stable >> (N + 1) & ~lastColumn)) &
+        (antiDiagonal | (stable << (N - 1) & ~lastColumn) |
+         (stable >> (N - 1) & ~firstColumn));
+    if (next == stable)
+      return stable;
+    stable = next;
+  }
+}
+
+Bitboard flips(int square, Bitboard player, Bitboard opponent) {
+  return bitboard::flips<N>(square, player, opponent);
+}
+
+/**
+ * @return The disc difference once nobody can move
+ */
+int finalScore(Bitboard player, Bitboard opponent) {
+  return bitboard::popcount(player) - bitboard::popcount(opponent);
+}
+} // namespace
+
+EndgameSolver::EndgameSolver(Mode mode)
+    : mode{mode}, table(std::size_t{1} << tableBits) {}
+
+std::optional<EndgameSolver::Result>
+EndgameSolver::solve(const Othello &othello, const SearchLimits &limits) {
+  this->limits = &limits;
+  nodes = 0;
+  nextCheck = checkInterval;
+  aborted = false;
+  const Bitboard player =
+      othello.isBlackTurn() ? othello.blackDiscs() : othello.whiteDiscs();
+  const Bitboard opponent =
+      othello.isBlackTurn() ? othello.whiteDiscs() : othello.blackDiscs();
+  // a win by a single disc is as good as any other win
+  const int alpha = mode == Mode::EXACT ? -infinity : -1;
+  const int beta = mode == Mode::EXACT ? infinity : 1;
+
+  Result result{.score = 0, .square = -1};
+  result.score = search(player, opponent, alpha, beta, &result.square);
+  if (aborted)
+    return std::nullopt;
+  if (mode == Mode::WIN_LOSS_DRAW)
+    result.score = (result.score > 0) - (result.score < 0);
+  return result;
+}
+
+int EndgameSolver::search(Bitboard player, Bitboard opponent, int alpha,
+                          int beta, int *bestMove) {
+  const Bitboard empty = ~(player | opponent) & Geometry::full;
+  const int empties = bitboard::popcount(empty);
+  // the root has to come up with a move, so it takes the long way
+  const bool root = bestMove != nullptr;
+  if (empties <= 4 && !root) {
+    std::array<int, 4> squares{};
+    // parity: the squares in quadrants with an odd number of empties first
+    Bitboard odd = oddQuadrants(empty);
+    Bitboard even = empty & ~odd;
+    for (int i = 0; i < empties; ++i)
+      squares[i] = bitboard::popSquare(odd ? odd : even);
+    switch (empties) {
+    case 4:
+      return solve4(player, opponent, alpha, beta, false, squares[0],
+                    squares[1], squares[2], squares[3]);
+    case 3:
+      return solve3(player, opponent, alpha, beta, false, squares[0],
+                    squares[1], squares[2]);
+    case 2:
+      return solve2(player, opponent, alpha, beta, false, squares[0],
+                    squares[1]);
+    case 1:
+      return solve1(player, opponent, squares[0]);
+    default:
+      return finalScore(player, opponent);
+    }
+  }
+  if (stop())
+    return 0;
+
+  // the opponent keeps its stable discs whatever happens
+  if (!root && N * N - 2 * bitboard::popcount(opponent) <= alpha) {
+    const int upper =
+        N * N - 2 * bitboard::popcount(
+                        stableDiscs(opponent, player | opponent));
+    if (upper <= alpha)
+      return upper;
+  }
+
+  const int originalAlpha = alpha;
+  const int originalBeta = beta;
+  Entry *entry = nullptr;
+  int hashMove = -1;
+  if (empties >= tableEmpties) {
+    entry = &entryFor(player, opponent);
+    if (entry->player == player && entry->opponent == opponent) {
+      if (!root && (entry->lower >= beta || entry->lower == entry->upper))
+        return entry->lower;
+      if (!root && entry->upper <= alpha)
+        return entry->upper;
+      hashMove = entry->square;
+    } else {
+      entry->player = player;
+      entry->opponent = opponent;
+      entry->lower = -infinity;
+      entry->upper = infinity;
+      entry->square = -1;
+    }
+  }
+
+  Bitboard moves = bitboard::legalMoves<N>(player, opponent);
+  if (!moves) {
+    if (!bitboard::legalMoves<N>(opponent, player))
+      return finalScore(player, opponent);
+    return -search(opponent, player, -beta, -alpha);
+  }
+
+  std::array<int, Othello::LegalMoves::capacity> squares;
+  int count = 0;
+  if (empties >= fastestFirstEmpties) {
+    std::array<int, Othello::LegalMoves::capacity> keys;
+    while (moves) {
+      const int square = bitboard::popSquare(moves);
+      const Bitboard flipped = flips(square, player, opponent);
+      const int replies = bitboard::popcount(bitboard::legalMoves<N>(
+          opponent & ~flipped, player | flipped | bit(square)));
+      // the best move so far comes first, corners are worth a reply or two
+      keys[count] = square == hashMove                     ? -infinity
+                    : (Geometry::corners & bit(square)) != 0 ? 2 * replies - 3
+                                                           : 2 * replies;
+      squares[count++] = square;
+    }
+    for (int i = 1; i < count; ++i)
+      for (int j = i; j > 0 && keys[j] < keys[j - 1]; --j) {
+        std::swap(keys[j], keys[j - 1]);
+        std::swap(squares[j], squares[j - 1]);
+      }
+  } else {
+    const Bitboard odd = oddQuadrants(empty);
+    for (Bitboard first = moves & odd; first;)
+      squares[count++] = bitboard::popSquare(first);
+    for (Bitboard rest = moves & ~odd; rest;)
+      squares[count++] = bitboard::popSquare(rest);
+  }
+
+  int best = -infinity;
+  int bestSquare = -1;
+  for (int i = 0; i < count; ++i) {
+    const int square = squares[i];
+    const Bitboard flipped = flips(square, player, opponent);
+    const Bitboard nextPlayer = opponent & ~flipped;
+    const Bitboard nextOpponent = player | flipped | bit(square);
+    int score;
+    if (i == 0) {
+      score = -search(nextPlayer, nextOpponent, -beta, -alpha);
+    } else {
+      // prove the move is no better, and only search it properly if it is
+      score = -search(nextPlayer, nextOpponent, -alpha - 1, -alpha);
+      if (score > alpha && score < beta)
+        score = -search(nextPlayer, nextOpponent, -beta, -alpha);
+    }
+    if (aborted)
+      return 0;
+    if (score > best) {
+      best = score;
+      bestSquare = square;
+      if (score >= beta)
+        break;
+      alpha = std::max(alpha, score);
+    }
+  }
+
+  if (entry) {
+    // a lookup further down may have reused the entry for another position
+    entry = &entryFor(player, opponent);
+    if (entry->player != player || entry->opponent != opponent) {
+      entry->player = player;
+      entry->opponent = opponent;
+      entry->lower = -infinity;
+      entry->upper = infinity;
+    }
+    if (best > originalAlpha)
+      entry->lower = static_cast<std::int8_t>(best);
+    if (best < originalBeta)
+      entry->upper = static_cast<std::int8_t>(best);
+    entry->square = static_cast<std::int8_t>(bestSquare);
+  }
+  if (root)
+    *bestMove = bestSquare;
+  return best;
+}
+
+int EndgameSolver::solve4(Bitboard player, Bitboard opponent, int alpha,
+                          int beta, bool passed, int x1, int x2, int x3,
+                          int x4) {
+  ++nodes;
+  int best = -infinity;
+  if (const Bitboard flipped = flips(x1, player, opponent)) {
+    best = -solve3(opponent & ~flipped, player | flipped | bit(x1), -beta,
+                   -alpha, false, x2, x3, x4);
+    if (best >= beta)
+      return best;
+    alpha = std::max(alpha, best);
+  }
+  if (const Bitboard flipped = flips(x2, player, opponent)) {
+    const int score = -solve3(opponent & ~flipped, player | flipped | bit(x2),
+                              -beta, -alpha, false, x1, x3, x4);
+    if (score >= beta)
+      return score;
+    best = std::max(best, score);
+    alpha = std::max(alpha, score);
+  }
+  if (const Bitboard flipped = flips(x3, player, opponent)) {
+    const int score = -solve3(opponent & ~flipped, player | flipped | bit(x3),
+                              -beta, -alpha, false, x1, x2, x4);
+    if (score >= beta)
+      return score;
+    best = std::max(best, score);
+    alpha = std::max(alpha, score);
+  }
+  if (const Bitboard flipped = flips(x4, player, opponent)) {
+    const int score = -solve3(opponent & ~flipped, player | flipped | bit(x4),
+                              -beta, -alpha, false, x1, x2, x3);
+    best = std::max(best, score);
+  }
+  if (best == -infinity)
+    return passed ? finalScore(player, opponent)
+                  : -solve4(opponent, player, -beta, -alpha, true, x1, x2, x3,
+                            x4);
+  return best;
+}
+
+int EndgameSolver::solve3(Bitboard player, Bitboard opponent, int alpha,
+                          int beta, bool passed, int x1, int x2, int x3) {
+  ++nodes;
+  int best = -infinity;
+  if (const Bitboard flipped = flips(x1, player, opponent)) {
+    best = -solve2(opponent & ~flipped, player | flipped | bit(x1), -beta,
+                   -alpha, false, x2, x3);
+    if (best >= beta)
+      return best;
+    alpha = std::max(alpha, best);
+  }
+  if (const Bitboard flipped = flips(x2, player, opponent)) {
+    const int score = -solve2(opponent & ~flipped, player | flipped | bit(x2),
+                              -beta, -alpha, false, x1, x3);
+    if (score >= beta)
+      return score;
+    best = std::max(best, score);
+    alpha = std::max(alpha, score);
+  }
+  if (const Bitboard flipped = flips(x3, player, opponent)) {
+    const int score = -solve2(opponent & ~flipped, player | flipped | bit(x3),
+                              -beta, -alpha, false, x1, x2);
+    best = std::max(best, score);
+  }
+  if (best == -infinity)
+    return passed ? finalScore(player, opponent)
+                  : -solve3(opponent, player, -beta, -alpha, true, x1, x2, x3);
+  return best;
+}
+
+int EndgameSolver::solve2(Bitboard player, Bitboard opponent, int alpha,
+                          int beta, bool passed, int x1, int x2) {
+  ++nodes;
+  int best = -infinity;
+  if (const Bitboard flipped = flips(x1, player, opponent)) {
+    best = -solve1(opponent & ~flipped, player | flipped | bit(x1), x2);
+    if (best >= beta)
+      return best;
+  }
+  if (const Bitboard flipped = flips(x2, player, opponent)) {
+    const int score =
+        -solve1(opponent & ~flipped, player | flipped | bit(x2), x1);
+    best = std::max(best, score);
+  }
+  if (best == -infinity)
+    return passed ? finalScore(player, opponent)
+                  : -solve2(opponent, player, -beta, -alpha, true, x1, x2);
+  return best;
+}
+
+int EndgameSolver::solve1(Bitboard player, Bitboard opponent, int x1) {
+  ++nodes;
+  // with one square left, the move there decides everything
+  const int score = finalScore(player, opponent);
+  if (const Bitboard flipped = flips(x1, player, opponent))
+    return score + 1 + 2 * bitboard::popcount(flipped);
+  if (const Bitboard flipped = flips(x1, opponent, player))
+    return score - 1 - 2 * bitboard::popcount(flipped);
+  return score;
+}
+
+bool EndgameSolver::stop() {
+  ++nodes;
+  if (!aborted && nodes >= nextCheck) {
+    nextCheck = nodes + checkInterval;
+    aborted = nodes >= limits->maxNodes ||
+              limits->stopToken.stop_requested() ||
+              (limits->deadline &&
+               SearchLimits::Clock::now() >= *limits->deadline);
+  }
+  return aborted;
+}
+
+EndgameSolver::Entry &EndgameSolver::entryFor(Bitboard player,
+                                              Bitboard opponent) {
+  const std::uint64_t hash =
+      (player * 0x9E3779B97F4A7C15u) ^ (opponent * 0xC2B2AE3D27D4EB4Fu);
+  return table[hash >> (64 - tableBits)];
+}
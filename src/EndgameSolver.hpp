@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Othello.hpp"
+#include "SearchLimits.hpp"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * Searches endgames to the last move, which the heuristics can only guess
+ * at. Solving about twenty empty squares is practical, every square more
+ * takes a few times as long.
+ *
+ * Scores are final disc differences without giving the empty squares to
+ * either side, the way BasicOthello::score counts them.
+ */
+class EndgameSolver {
+public:
+  enum class Mode {
+    /** Finds the best final disc difference */
+    EXACT,
+    /**
+     * Only finds whether the game is won, lost or drawn, which prunes much
+     * more than EXACT
+     */
+    WIN_LOSS_DRAW
+  };
+
+  struct Result {
+    /**
+     * The final disc difference for the side to move, only its sign in
+     * WIN_LOSS_DRAW, -1, 0 or 1
+     */
+    int score;
+    /** The square of the best move, -1 when the side to move has to pass */
+    int square;
+  };
+
+  explicit EndgameSolver(Mode mode = Mode::EXACT);
+
+  /**
+   * @param othello
+   * @param limits The node and time limits to give up at, the depth limit
+   * does not apply
+   * @return The solution, none if it ran out of limits first
+   */
+  std::optional<Result> solve(const Othello &othello,
+                              const SearchLimits &limits = {});
+
+  /**
+   * @return The positions the last solve visited
+   */
+  [[nodiscard]] std::uint64_t nodeCount() const { return nodes; }
+
+private:
+  using Bitboard = Othello::Bitboard;
+
+  /**
+   * Bounds on the score of a position solved before, kept across solves
+   * because they never stop being true
+   */
+  struct Entry {
+    Bitboard player = 0;
+    Bitboard opponent = 0;
+    std::int8_t lower = 0;
+    std::int8_t upper = 0;
+    /** The best move found, -1 for none */
+    std::int8_t square = -1;
+  };
+
+  /**
+   * Negamax with null windows on all but the first move
+   * @param player The discs of the side to move
+   * @param opponent
+   * @param alpha
+   * @param beta
+   * @param bestMove Where to put the square of the best move, only passed at
+   * the root, which never cuts its search short
+   * @return The score for the side to move, a bound when it is not between
+   * alpha and beta
+   */
+  int search(Bitboard player, Bitboard opponent, int alpha, int beta,
+             int *bestMove = nullptr);
+
+  /**
+   * The hand unrolled searches for the last four empty squares, which skip
+   * move generation and the table and simply try every square
+   */
+  int solve4(Bitboard player, Bitboard opponent, int alpha, int beta,
+             bool passed, int x1, int x2, int x3, int x4);
+
+  int solve3(Bitboard player, Bitboard opponent, int alpha, int beta,
+             bool passed, int x1, int x2, int x3);
+
+  int solve2(Bitboard player, Bitboard opponent, int alpha, int beta,
+             bool passed, int x1, int x2);
+
+  int solve1(Bitboard player, Bitboard opponent, int x1);
+
+  /**
+   * Counts a node and checks the limits every few thousand nodes
+   * @return Whether to give up
+   */
+  bool stop();
+
+  [[nodiscard]] Entry &entryFor(Bitboard player, Bitboard opponent);
+
+  const Mode mode;
+  std::vector<Entry> table;
+  const SearchLimits *limits = nullptr;
+  std::uint64_t nodes = 0;
+  std::uint64_t nextCheck = 0;
+  bool aborted = false;
+};
@@ -16,7 +16,10 @@ using WrappedExceptionType =
 using WrappedExceptionMessage =
     boost::error_info<struct wrapped_exception_message, std::string>;
 using Move = boost::error_info<struct move, std::pair<int, int>>;
-using Board = boost::error_info<struct board_state, Othello::BoardState>;
+template <int N>
+using BasicBoard =
+    boost::error_info<struct board_state, typename BasicOthello<N>::BoardState>;
+using Board = BasicBoard<Othello::boardSize>;
 
 class Exception : public virtual std::exception,
                   public virtual boost::exception {
@@ -1,5 +1,13 @@
 #pragma once
 
-class Othello;
+#include "OthelloFwd.hpp"
+#include <span>
 
 using HeuristicFunction = double (*)(const Othello &);
+
+/**
+ * Scores many positions in one call, writing the score of positions[i] to
+ * scores[i]. The scores must have room for every position.
+ */
+using BatchHeuristicFunction = void (*)(std::span<const Othello> positions,
+                                        std::span<double> scores);
@@ -0,0 +1,135 @@
+#include "KillerHistoryOrderer.hpp"
+#include "evaluateBatch.hpp"
+#include <limits>
+
+namespace {
+constexpr int boardSize = Othello::boardSize;
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+
+/** Where the history counts are halved, well below overflowing */
+constexpr std::uint32_t historyLimit = 1u << 30;
+
+/** How many different priorities squarePriorities hands out */
+constexpr int priorities = 4;
+
+/**
+ * Corners first, then the rest of the edges, then the middle of the board,
+ * and last the squares diagonally next to a corner, which tend to give the
+ * corner away
+ */
+constexpr std::array<int, boardSize * boardSize> squarePriorities = [] {
+  std::array<int, boardSize * boardSize> squarePriorities{};
+  const auto onEdge = [](int i) { return i == 0 || i == boardSize - 1; };
+  const auto nextToEdge = [](int i) { return i == 1 || i == boardSize - 2; };
+  for (int y = 0; y < boardSize; ++y)
+    for (int x = 0; x < boardSize; ++x)
+      squarePriorities[bitboard::square<boardSize>(x, y)] =
+          onEdge(x) && onEdge(y)           ? 3
+          : onEdge(x) || onEdge(y)         ? 2
+          : nextToEdge(x) && nextToEdge(y) ? 0
+                                           : 1;
+  return squarePriorities;
+}();
+
+/**
+ * A tiny per thread offset that breaks ties differently on every thread
+ */
+double tieBreak(int square, int thread) {
+  const std::uint32_t mixed = (square + 1) * 0x9E3779B1u * thread;
+  return (mixed >> 24) * 1e-9;
+}
+} // namespace
+
+KillerHistoryOrderer::KillerHistoryOrderer(int thread) : thread{thread} {
+  KillerHistoryOrderer::newSearch();
+}
+
+void KillerHistoryOrderer::newSearch() {
+  for (std::array<int, 2> &killer : killers)
+    killer = {-1, -1};
+  for (std::array<std::uint32_t, boardSize * boardSize> &counts : history)
+    for (std::uint32_t &count : counts)
+      count /= 2;
+}
+
+void KillerHistoryOrderer::order(HeuristicFunction heuristic,
+                                 Othello &othello,
+                                 const LegalMoves &legalMoves, Bitboard allowed,
+                                 int hashMove, int ply, int depth,
+                                 Order &order) {
+  constexpr Bitboard corners = bitboard::Geometry<boardSize>::corners;
+  // scoring every move only pays for itself a few plies above the leaves
+  const bool useHeuristic = depth > 2;
+  const std::array<int, 2> &killer = killers[ply];
+  const std::array<std::uint32_t, boardSize * boardSize> &counts =
+      history[othello.isBlackTurn()];
+  std::array<double, LegalMoves::capacity> keys;
+  // the moves left to the heuristic, whose positions are scored together
+  // once the loop has collected them all
+  std::array<int, LegalMoves::capacity> childMoves;
+  std::array<double, LegalMoves::capacity> childScores;
+  int childCount = 0;
+  order.size = 0;
+  // the move of the table first, then corners and killers, then the moves
+  // that leave the opponent with the worst heuristic score, or near the
+  // leaves the ones with the most cutoffs
+  for (int i = 0; i < legalMoves.size(); ++i) {
+    const LegalMove &move = legalMoves[i];
+    const Bitboard bit = Bitboard{1} << move.square;
+    if (!(allowed & bit))
+      continue;
+    double key = 0;
+    if (move.square == hashMove) {
+      key = infinity;
+    } else if (corners & bit) {
+      key = std::numeric_limits<double>::max();
+    } else if (move.square == killer[0]) {
+      key = std::numeric_limits<double>::max() / 2;
+    } else if (move.square == killer[1]) {
+      key = std::numeric_limits<double>::max() / 4;
+    } else if (useHeuristic) {
+      const Othello::UndoInfo undoInfo = othello.doMove(move);
+      children[childCount] = othello;
+      childMoves[childCount++] = i;
+      othello.undoMove(undoInfo);
+    } else {
+      key = static_cast<double>(counts[move.square]) * priorities +
+            squarePriorities[move.square];
+    }
+    keys[i] = key + tieBreak(move.square, thread);
+    order.indices[order.size++] = i;
+  }
+  evaluateBatch(heuristic, std::span{children}.first(childCount),
+                childScores);
+  for (int i = 0; i < childCount; ++i)
+    keys[childMoves[i]] -= childScores[i];
+  // std::stable_sort wants a buffer from the heap, an insertion sort is just
+  // as stable and the lists are short
+  for (int i = 1; i < order.size; ++i) {
+    const int index = order.indices[i];
+    int j = i;
+    for (; j > 0 && keys[order.indices[j - 1]] < keys[index]; --j)
+      order.indices[j] = order.indices[j - 1];
+    order.indices[j] = index;
+  }
+}
+
+void KillerHistoryOrderer::cutoff(const Othello &othello, int square,
+                                  int ply, int depth) {
+  std::array<int, 2> &killer = killers[ply];
+  if (killer[0] != square) {
+    killer[1] = killer[0];
+    killer[0] = square;
+  }
+  std::array<std::uint32_t, boardSize * boardSize> &counts =
+      history[othello.isBlackTurn()];
+  counts[square] += depth * depth;
+  // keep the counts far from overflowing in long searches, only how they
+  // compare matters
+  if (counts[square] > historyLimit)
+    for (std::array<std::uint32_t, boardSize * boardSize> &sideCounts :
+         history)
+      for (std::uint32_t &count : sideCounts)
+        count /= 2;
+}
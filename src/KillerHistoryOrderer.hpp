@@ -0,0 +1,60 @@
+#pragma once
+
+#include "MoveOrderer.hpp"
+#include <array>
+#include <cstdint>
+
+/**
+ * The move orderer MinMaxStrategy uses unless it is given another one.
+ *
+ * Besides the move the transposition table remembers, it learns from the
+ * moves that caused cutoffs: the last two killer moves at every ply, which
+ * are often good in the sibling positions too, and a history table that
+ * counts the cutoffs of every square for either side. Moves it knows
+ * nothing about go by a static priority of their square.
+ */
+class alignas(64) KillerHistoryOrderer : public MoveOrderer {
+public:
+  /**
+   * @param thread Numbers the threads of a parallel search. Every thread
+   * breaks ties between moves differently, so that they explore the moves
+   * in different orders.
+   */
+  explicit KillerHistoryOrderer(int thread = 0);
+
+  /**
+   * Halves the history, so that what earlier searches learned counts for
+   * less than what the next one learns, and forgets the killer moves, whose
+   * plies refer to another root
+   */
+  void newSearch() override;
+
+  /**
+   * Scores the moves with the heuristic a few plies above the leaves, every
+   * child it is needed for in one batch, and by their history nearer to
+   * the leaves
+   */
+  void order(HeuristicFunction heuristic, Othello &othello,
+             const LegalMoves &legalMoves, Bitboard allowed, int hashMove,
+             int ply, int depth, Order &order) override;
+
+  /**
+   * Remembers the move as a killer and in the history, where deeper
+   * cutoffs count for more
+   */
+  void cutoff(const Othello &othello, int square, int ply,
+              int depth) override;
+
+private:
+  const int thread;
+  std::array<std::array<int, 2>, maxPly> killers;
+  /** The cutoffs by square, for white and for black */
+  std::array<std::array<std::uint32_t, Othello::boardSize * Othello::boardSize>,
+             2>
+      history{};
+  /**
+   * The positions order scores with the heuristic, kept here so that
+   * order does not construct a board for every legal move at every node
+   */
+  std::array<Othello, LegalMoves::capacity> children;
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "OthelloFwd.hpp"
+#include "bitboard.hpp"
+#include <array>
+
+template <int N> struct BasicLegalMove {
+  int square;
+  /** The opponent discs that this move turns over */
+  bitboard::BasicBitboard<N> flips;
+
+  [[nodiscard]] int x() const { return square % N; }
+
+  [[nodiscard]] int y() const { return square / N; }
+};
+
+/**
+ * A fixed capacity list of the legal moves in a position.
+ *
+ * Lives entirely on the stack so it can be built in a search without
+ * allocating. Moves are stored in square order, which lets a lookup find its
+ * entry by counting the legal squares before it rather than scanning.
+ */
+template <int N> class BasicLegalMoves {
+public:
+  using Bitboard = bitboard::BasicBitboard<N>;
+  using const_iterator = const BasicLegalMove<N> *;
+
+  /**
+   * Every square that is empty at the start of the game. Positions with more
+   * than 32 legal moves are rare but reachable, so this does not try to be
+   * any tighter.
+   */
+  static constexpr int capacity = N * N - 4;
+
+  BasicLegalMoves() = default;
+
+  BasicLegalMoves(Bitboard player, Bitboard opponent) {
+    generate(player, opponent);
+  }
+
+  /**
+   * Replaces the moves with the ones of another position, which saves
+   * copying a whole list into storage that is reused
+   * @param player The discs of the side to move
+   * @param opponent
+   */
+  void generate(Bitboard player, Bitboard opponent) {
+    mask_ = bitboard::legalMoves<N>(player, opponent);
+    size_ = 0;
+    Bitboard moves = mask_;
+    while (moves) {
+      const int square = bitboard::popSquare(moves);
+      moves_[size_++] = {square,
+                         bitboard::flips<N>(square, player, opponent)};
+    }
+  }
+
+  [[nodiscard]] const_iterator begin() const { return moves_.data(); }
+
+  [[nodiscard]] const_iterator end() const { return moves_.data() + size_; }
+
+  [[nodiscard]] const BasicLegalMove<N> &operator[](int i) const {
+    return moves_[i];
+  }
+
+  [[nodiscard]] int size() const { return size_; }
+
+  [[nodiscard]] bool empty() const { return size_ == 0; }
+
+  /**
+   * @return A bitboard with a bit set on every legal square
+   */
+  [[nodiscard]] Bitboard mask() const { return mask_; }
+
+  [[nodiscard]] bool contains(int x, int y) const {
+    return x >= 0 && x < N && y >= 0 && y < N &&
+           (mask_ & Bitboard{1} << bitboard::square<N>(x, y));
+  }
+
+  /**
+   * @param x
+   * @param y
+   * @return The move on the given square, or end() if it is not legal
+   */
+  [[nodiscard]] const_iterator find(int x, int y) const {
+    if (!contains(x, y))
+      return end();
+    const Bitboard before = (Bitboard{1} << bitboard::square<N>(x, y)) - 1;
+    return begin() + bitboard::popcount(mask_ & before);
+  }
+
+private:
+  std::array<BasicLegalMove<N>, capacity> moves_;
+  int size_ = 0;
+  Bitboard mask_ = 0;
+};
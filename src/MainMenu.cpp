@@ -1,5 +1,7 @@
 #include "MainMenu.hpp"
+#include "MctsStrategy.hpp"
 #include "MinMaxStrategy.hpp"
+#include "OpeningBook.hpp"
 #include "OthelloWindow.hpp"
 #include "RandomAi.hpp"
 #include "StrategicAi.hpp"
@@ -8,6 +10,25 @@
 #include "gui/ImGuiWrapper.hpp"
 #include "mobilityHeuristic.hpp"
 #include "stabilityHeuristic.hpp"
+#include "util/define_logger.hpp"
+#include <boost/exception/diagnostic_information.hpp>
+#include <filesystem>
+
+DEFINE_LOGGER(MainMenu)
+
+MainMenu::MainMenu(gui::ImGuiWrapper &imGuiWrapper,
+                   OthelloWindow &othelloWindow)
+    : imGuiWrapper{imGuiWrapper}, othelloWindow{othelloWindow} {
+  if (!std::filesystem::exists(openingBookPath))
+    return;
+  try {
+    openingBook = std::make_shared<const OpeningBook>(openingBookPath);
+  } catch (...) {
+    LOG4CPLUS_WARN(GetLogger(),
+                   "Playing without an opening book: "
+                       << boost::current_exception_diagnostic_information());
+  }
+}
 
 void MainMenu::operator()() {
   imGuiWrapper.mainMenu([this] { gameMenu(); });
@@ -17,6 +38,16 @@ void MainMenu::gameMenu() {
   imGuiWrapper.menu("Game", true, [this] {
     imGuiWrapper.menuItem("2 player", false, true,
                           [this] { othelloWindow.reset(nullptr); });
+    imGuiWrapper.menuItem("Ponder on your turn", othelloWindow.pondering(),
+                          true, [this] {
+                            othelloWindow.setPondering(
+                                !othelloWindow.pondering());
+                          });
+    imGuiWrapper.menuItem("Show move scores", othelloWindow.analyzing(), true,
+                          [this] {
+                            othelloWindow.setAnalyzing(
+                                !othelloWindow.analyzing());
+                          });
     imGuiWrapper.menu("Against computer", true, [this] {
       imGuiWrapper.menuItem("Random", false, true, [this] {
         othelloWindow.reset(std::make_unique<RandomAI>());
@@ -29,6 +60,41 @@ void MainMenu::gameMenu() {
           "MinMax - Stability", 5);
       strategicAiMenuItem<compositeHeuristic, MinMaxStrategy>(
           "MinMax - Composite", 5);
+      strategicAiMenuItem<coinParityHeuristic, MinMaxStrategy>(
+          "AlphaBeta - Coin Parity", 8, MinMaxStrategy::Search::ALPHA_BETA);
+      strategicAiMenuItem<mobilityHeuristic, MinMaxStrategy>(
+          "AlphaBeta - Mobility", 7, MinMaxStrategy::Search::ALPHA_BETA);
+      strategicAiMenuItem<stabilityHeuristic, MinMaxStrategy>(
+          "AlphaBeta - Stability", 8, MinMaxStrategy::Search::ALPHA_BETA);
+      strategicAiMenuItem<compositeHeuristic, MinMaxStrategy>(
+          "AlphaBeta - Composite", 7, MinMaxStrategy::Search::ALPHA_BETA);
+      strategicAiMenuItem<compositeHeuristic, MinMaxStrategy>(
+          "PVS - Composite", 8, MinMaxStrategy::Search::PRINCIPAL_VARIATION);
+      imGuiWrapper.menu("Lazy SMP - 1 second per move", true, [this] {
+        constexpr std::chrono::seconds moveTime{1};
+        constexpr int maxDepth = 64;
+        constexpr auto search = MinMaxStrategy::Search::LAZY_SMP;
+        constexpr int allCores = 0;
+        timedAiMenuItem<coinParityHeuristic, MinMaxStrategy>(
+            "Coin Parity", moveTime, maxDepth, search, allCores);
+        timedAiMenuItem<mobilityHeuristic, MinMaxStrategy>(
+            "Mobility", moveTime, maxDepth, search, allCores);
+        timedAiMenuItem<stabilityHeuristic, MinMaxStrategy>(
+            "Stability", moveTime, maxDepth, search, allCores);
+        timedAiMenuItem<compositeHeuristic, MinMaxStrategy>(
+            "Composite", moveTime, maxDepth, search, allCores);
+      });
+      imGuiWrapper.menu("MCTS - 1 second per move", true, [this] {
+        constexpr std::chrono::seconds moveTime{1};
+        constexpr int allCores = 0;
+        // random playouts never look at the heuristic
+        timedAiMenuItem<coinParityHeuristic, MctsStrategy>(
+            "Random playouts", moveTime, MctsStrategy::Playout::RANDOM,
+            allCores);
+        timedAiMenuItem<compositeHeuristic, MctsStrategy>(
+            "Composite playouts", moveTime, MctsStrategy::Playout::HEURISTIC,
+            allCores);
+      });
     });
   });
 }
@@ -38,6 +104,21 @@ void MainMenu::strategicAiMenuItem(const char *label, Args &&...args) {
   static_assert(std::is_constructible_v<Strategy, Args...>);
   imGuiWrapper.menuItem(label, false, true, [&] {
     othelloWindow.reset(std::make_unique<StrategicAi>(
-        std::make_unique<Strategy>(std::forward<Args>(args)...), function));
+        std::make_unique<Strategy>(std::forward<Args>(args)...), function,
+        std::nullopt, StrategicAi::defaultSolverEmpties,
+        EndgameSolver::Mode::EXACT, openingBook));
+  });
+}
+
+template <HeuristicFunction function, class Strategy, class... Args>
+void MainMenu::timedAiMenuItem(const char *label,
+                               SearchLimits::Clock::duration moveTime,
+                               Args &&...args) {
+  static_assert(std::is_constructible_v<Strategy, Args...>);
+  imGuiWrapper.menuItem(label, false, true, [&] {
+    othelloWindow.reset(std::make_unique<StrategicAi>(
+        std::make_unique<Strategy>(std::forward<Args>(args)...), function,
+        moveTime, StrategicAi::defaultSolverEmpties,
+        EndgameSolver::Mode::EXACT, openingBook));
   });
 }
@@ -1,17 +1,23 @@
 #pragma once
 
 #include "HeuristicFunction.hpp"
+#include "SearchLimits.hpp"
+#include <memory>
 
 namespace gui {
 struct ImGuiWrapper;
 }
 
+class OpeningBook;
+
 class OthelloWindow;
 
 class MainMenu {
 public:
-  MainMenu(gui::ImGuiWrapper &imGuiWrapper, OthelloWindow &othelloWindow)
-      : imGuiWrapper{imGuiWrapper}, othelloWindow{othelloWindow} {}
+  /** The AIs play from this book when the working directory has it */
+  static constexpr const char *openingBookPath = "othello.book";
+
+  MainMenu(gui::ImGuiWrapper &imGuiWrapper, OthelloWindow &othelloWindow);
 
   void operator()();
 
@@ -21,6 +27,11 @@ private:
   template <HeuristicFunction function, class Strategy, class... Args>
   void strategicAiMenuItem(const char *label, Args &&...args);
 
+  template <HeuristicFunction function, class Strategy, class... Args>
+  void timedAiMenuItem(const char *label,
+                       SearchLimits::Clock::duration moveTime, Args &&...args);
+
   gui::ImGuiWrapper &imGuiWrapper;
   OthelloWindow &othelloWindow;
+  std::shared_ptr<const OpeningBook> openingBook;
 };
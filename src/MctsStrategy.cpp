@@ -0,0 +1,452 @@
+#include "MctsStrategy.hpp"
+#include "Exception.hpp"
+#include "SearchProgress.hpp"
+#include "util/define_logger.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+DEFINE_LOGGER(MctsStrategy)
+
+namespace {
+/**
+ * The weight of exploring rarely visited moves against exploiting the ones
+ * that won most, the usual square root of two for rewards between 0 and 1
+ */
+const double exploration = std::sqrt(2.0);
+
+/**
+ * A leaf gets its children on this visit. Growing the tree on the first
+ * visit would spend most of the memory on nodes that are never seen again.
+ */
+constexpr std::uint32_t expansionVisits = 2;
+
+/** How many playouts of the calling thread go by between progress reports */
+constexpr std::uint64_t progressPlayouts = 16384;
+
+int coreCount() {
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+/**
+ * @return The legal move on the square, with the discs it flips
+ */
+LegalMove moveOn(const Othello &othello, int square) {
+  const Othello::Bitboard own =
+      othello.isBlackTurn() ? othello.blackDiscs() : othello.whiteDiscs();
+  const Othello::Bitboard opponent =
+      othello.isBlackTurn() ? othello.whiteDiscs() : othello.blackDiscs();
+  return {square, bitboard::flips<Othello::boardSize>(square, own, opponent)};
+}
+
+/**
+ * Plays the move on the square, or passes when the square is -1
+ */
+void play(Othello &othello, int square) {
+  if (square < 0)
+    othello.doPass();
+  else
+    othello.doMove(moveOn(othello, square));
+}
+
+/**
+ * @return One of the squares of the mask, which must not be empty
+ */
+int randomSquare(Othello::Bitboard mask, std::mt19937 &generator) {
+  const int count = bitboard::popcount(mask);
+  for (int skip = std::uniform_int_distribution{0, count - 1}(generator);
+       skip > 0; --skip)
+    mask &= mask - 1;
+  return bitboard::countrZero(mask);
+}
+} // namespace
+
+struct MctsStrategy::Node {
+  enum Expansion : std::uint8_t { LEAF, EXPANDING, EXPANDED };
+
+  /**
+   * Playouts through this node, including the ones still running. Those
+   * count as lost until their result comes in.
+   */
+  std::atomic_uint32_t visits;
+  /**
+   * Playouts won by the player who moved to this node count twice, drawn
+   * ones once
+   */
+  std::atomic_uint32_t halfWins;
+  /** Only meaningful once expansion reads EXPANDED */
+  std::uint32_t firstChild;
+  std::uint8_t childCount;
+  /** The move that leads here, -1 for a pass */
+  std::int8_t square;
+  std::atomic<Expansion> expansion;
+
+  /**
+   * Turns the node into a leaf that was never visited, pool nodes are
+   * recycled from one search to the next
+   */
+  void reset(int move) {
+    visits.store(0, std::memory_order_relaxed);
+    halfWins.store(0, std::memory_order_relaxed);
+    firstChild = 0;
+    childCount = 0;
+    square = static_cast<std::int8_t>(move);
+    expansion.store(LEAF, std::memory_order_relaxed);
+  }
+};
+
+MctsStrategy::Pool::Pool(std::size_t capacity)
+    : nodes{std::make_unique<Node[]>(capacity)}, capacity{capacity} {}
+
+MctsStrategy::Pool::~Pool() = default;
+
+std::int64_t MctsStrategy::Pool::allocate(int count) {
+  const std::size_t first = used.fetch_add(count, std::memory_order_relaxed);
+  // a failed allocation leaves used past the end, so the later ones fail too
+  if (first + count > capacity)
+    return -1;
+  return static_cast<std::int64_t>(first);
+}
+
+MctsStrategy::MctsStrategy(Playout playout, int threads,
+                           std::uint64_t playouts, std::size_t megabytes)
+    : playout{playout}, threads{threads > 0 ? threads : coreCount()},
+      playouts{playouts} {
+  const std::size_t capacity =
+      std::max<std::size_t>((megabytes << 20) / 2 / sizeof(Node), 1);
+  tree = std::make_unique<Pool>(capacity);
+  spare = std::make_unique<Pool>(capacity);
+}
+
+AI::Move MctsStrategy::nextMove(HeuristicFunction heuristic,
+                                const Othello &othello) {
+  return nextMove(heuristic, othello, {});
+}
+
+AI::Move MctsStrategy::nextMove(HeuristicFunction heuristic,
+                                const Othello &othello,
+                                const SearchLimits &limits) {
+  const bool limited =
+      limits.deadline ||
+      limits.maxNodes != std::numeric_limits<std::uint64_t>::max();
+  grow(heuristic, othello, limits, limited ? limits.maxNodes : playouts);
+
+  const Node &root = tree->nodes[0];
+  const Node *best = nullptr;
+  for (int i = 0; i < root.childCount; ++i) {
+    const Node &child = tree->nodes[root.firstChild + i];
+    if (!best || child.visits > best->visits)
+      best = &child;
+  }
+  if (!best || best->square < 0)
+    THROW_SIMPLE_EXCEPTION("No move was selected");
+  LOG4CPLUS_DEBUG(GetLogger(),
+                  playoutsDone << " playouts, " << treeSize() << " nodes, "
+                               << best->visits << " visits and "
+                               << best->halfWins / 2.0 << " wins for the move");
+  return {best->square % Othello::boardSize,
+          best->square / Othello::boardSize};
+}
+
+void MctsStrategy::ponder(HeuristicFunction heuristic, const Othello &othello,
+                          std::stop_token stopToken) {
+  grow(heuristic, othello, {.stopToken = std::move(stopToken)},
+       std::numeric_limits<std::uint64_t>::max());
+}
+
+std::vector<MoveScore> MctsStrategy::analyze(HeuristicFunction heuristic,
+                                             const Othello &othello,
+                                             const SearchLimits &limits,
+                                             double) {
+  if (!othello.legalMoveMask())
+    return {};
+  const bool limited =
+      limits.deadline ||
+      limits.maxNodes != std::numeric_limits<std::uint64_t>::max();
+  grow(heuristic, othello, limits, limited ? limits.maxNodes : playouts, true);
+  return moveScores();
+}
+
+void MctsStrategy::grow(HeuristicFunction heuristic, const Othello &othello,
+                        const SearchLimits &limits, std::uint64_t budget,
+                        bool scoreMoves) {
+  if (heuristic != treeHeuristic) {
+    // HEURISTIC playouts grow a different tree with another heuristic
+    rootPosition.reset();
+    treeHeuristic = heuristic;
+  }
+  reroot(othello);
+  expand(tree->nodes[0], othello);
+
+  std::atomic_uint64_t started = 0;
+  std::atomic_uint64_t finished = 0;
+  const auto work = [&](std::uint32_t seed, bool reports) {
+    std::mt19937 generator{seed};
+    std::uint64_t count = 0;
+    while (started.fetch_add(1, std::memory_order_relaxed) < budget &&
+           !limits.stopToken.stop_requested() &&
+           !(limits.deadline &&
+             SearchLimits::Clock::now() >= *limits.deadline)) {
+      iterate(heuristic, generator);
+      ++count;
+      if (reports && limits.onProgress && count % progressPlayouts == 0)
+        limits.onProgress(progress(started, scoreMoves));
+    }
+    finished += count;
+  };
+  const std::uint32_t seed = std::random_device{}();
+  {
+    std::vector<std::jthread> helpers;
+    for (int thread = 1; thread < threads; ++thread)
+      helpers.emplace_back(work, seed + thread, false);
+    work(seed, true);
+  }
+  playoutsDone = finished;
+  if (limits.onProgress)
+    limits.onProgress(progress(playoutsDone, scoreMoves));
+}
+
+SearchProgress MctsStrategy::progress(std::uint64_t playouts,
+                                      bool scoreMoves) const {
+  SearchProgress progress{.principalVariation = {}, .nodes = playouts};
+  const Node &root = tree->nodes[0];
+  const Node *best = nullptr;
+  if (root.expansion.load(std::memory_order_acquire) == Node::EXPANDED)
+    for (int i = 0; i < root.childCount; ++i) {
+      const Node &child = tree->nodes[root.firstChild + i];
+      if (!best || child.visits > best->visits)
+        best = &child;
+    }
+  if (best && best->visits > 0)
+    progress.principalVariation = lineFrom(*best);
+  if (scoreMoves)
+    progress.moveScores = moveScores();
+  return progress;
+}
+
+PrincipalVariation MctsStrategy::lineFrom(const Node &node) const {
+  // the moves explored most, as far as the tree reaches
+  PrincipalVariation line;
+  const std::uint32_t visits = node.visits;
+  line.score = visits > 0 ? node.halfWins / (2.0 * visits) : 0;
+  const Node *next = &node;
+  while (true) {
+    line.moves.push_back(next->square < 0
+                             ? AI::Move{-1, -1}
+                             : AI::Move{next->square % Othello::boardSize,
+                                        next->square / Othello::boardSize});
+    if (next->expansion.load(std::memory_order_acquire) != Node::EXPANDED ||
+        next->childCount == 0)
+      break;
+    const Node *best = nullptr;
+    for (int i = 0; i < next->childCount; ++i) {
+      const Node &child = tree->nodes[next->firstChild + i];
+      if (!best || child.visits > best->visits)
+        best = &child;
+    }
+    if (best->visits == 0)
+      break;
+    next = best;
+  }
+  line.depth = static_cast<int>(line.moves.size());
+  return line;
+}
+
+std::vector<MoveScore> MctsStrategy::moveScores() const {
+  std::vector<MoveScore> scores;
+  const Node &root = tree->nodes[0];
+  if (root.expansion.load(std::memory_order_acquire) != Node::EXPANDED)
+    return scores;
+  for (int i = 0; i < root.childCount; ++i)
+    scores.push_back({.principalVariation =
+                          lineFrom(tree->nodes[root.firstChild + i])});
+  std::ranges::stable_sort(scores, std::greater{}, [](const MoveScore &score) {
+    return score.principalVariation.score;
+  });
+  return scores;
+}
+
+std::size_t MctsStrategy::treeSize() const {
+  return std::min(tree->used.load(), tree->capacity);
+}
+
+void MctsStrategy::reroot(const Othello &othello) {
+  if (rootPosition) {
+    // our move and the reply to it are usually the last two plies played
+    const auto find = [&](const auto &find, std::uint32_t index,
+                          const Othello &position,
+                          int plies) -> std::int64_t {
+      if (position == othello)
+        return index;
+      const Node &node = tree->nodes[index];
+      if (plies == 0 || node.expansion != Node::EXPANDED)
+        return -1;
+      for (int i = 0; i < node.childCount; ++i) {
+        const std::uint32_t child = node.firstChild + i;
+        Othello next = position;
+        play(next, tree->nodes[child].square);
+        if (const std::int64_t found = find(find, child, next, plies - 1);
+            found >= 0)
+          return found;
+      }
+      return -1;
+    };
+    if (const std::int64_t found = find(find, 0, *rootPosition, 2);
+        found >= 0) {
+      if (found > 0)
+        keepSubtree(static_cast<std::uint32_t>(found));
+      rootPosition = othello;
+      return;
+    }
+  }
+  tree->used = 1;
+  tree->nodes[0].reset(-1);
+  rootPosition = othello;
+}
+
+void MctsStrategy::keepSubtree(std::uint32_t node) {
+  const auto copy = [](const Node &from, Node &to) {
+    to.reset(from.square);
+    to.visits.store(from.visits, std::memory_order_relaxed);
+    to.halfWins.store(from.halfWins, std::memory_order_relaxed);
+  };
+  spare->used = 1;
+  copy(tree->nodes[node], spare->nodes[0]);
+  // breadth first, so that the children of a node stay next to each other
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> queue{{node, 0}};
+  for (std::size_t next = 0; next < queue.size(); ++next) {
+    const auto [from, to] = queue[next];
+    const Node &source = tree->nodes[from];
+    if (source.expansion != Node::EXPANDED)
+      continue;
+    Node &target = spare->nodes[to];
+    // the subtree came out of a pool of the same size, so it fits
+    const auto first =
+        static_cast<std::uint32_t>(spare->allocate(source.childCount));
+    for (int i = 0; i < source.childCount; ++i) {
+      copy(tree->nodes[source.firstChild + i], spare->nodes[first + i]);
+      queue.emplace_back(source.firstChild + i, first + i);
+    }
+    target.firstChild = first;
+    target.childCount = source.childCount;
+    target.expansion.store(Node::EXPANDED, std::memory_order_relaxed);
+  }
+  std::swap(tree, spare);
+}
+
+void MctsStrategy::iterate(HeuristicFunction heuristic,
+                           std::mt19937 &generator) {
+  struct Step {
+    Node *node;
+    bool blackMoved;
+  };
+  // a game has a move per empty square and at most a pass before each
+  std::array<Step, 2 * Othello::boardSize * Othello::boardSize> path;
+  int length = 0;
+
+  Othello othello = *rootPosition;
+  Node *node = &tree->nodes[0];
+  node->visits.fetch_add(1, std::memory_order_relaxed);
+  while (true) {
+    if (node->expansion.load(std::memory_order_acquire) != Node::EXPANDED &&
+        (node->visits.load(std::memory_order_relaxed) < expansionVisits ||
+         !expand(*node, othello)))
+      break;
+    if (node->childCount == 0)
+      break;
+
+    // UCT, moves nobody has tried yet come first
+    const double logVisits =
+        std::log(node->visits.load(std::memory_order_relaxed));
+    Node *selected = nullptr;
+    double selectedValue = -std::numeric_limits<double>::infinity();
+    for (int i = 0; i < node->childCount; ++i) {
+      Node &child = tree->nodes[node->firstChild + i];
+      const std::uint32_t visits = child.visits.load(std::memory_order_relaxed);
+      if (visits == 0) {
+        selected = &child;
+        break;
+      }
+      const double value =
+          child.halfWins.load(std::memory_order_relaxed) / (2.0 * visits) +
+          exploration * std::sqrt(logVisits / visits);
+      if (value > selectedValue) {
+        selected = &child;
+        selectedValue = value;
+      }
+    }
+    selected->visits.fetch_add(1, std::memory_order_relaxed);
+    path[length++] = {selected, othello.isBlackTurn()};
+    play(othello, selected->square);
+    node = selected;
+  }
+
+  const int discDifference = playOut(heuristic, othello, generator);
+  for (int i = 0; i < length; ++i) {
+    const int result = path[i].blackMoved ? discDifference : -discDifference;
+    path[i].node->halfWins.fetch_add(result > 0 ? 2 : result == 0 ? 1 : 0,
+                                     std::memory_order_relaxed);
+  }
+}
+
+bool MctsStrategy::expand(Node &node, const Othello &othello) {
+  Node::Expansion expansion = Node::LEAF;
+  if (!node.expansion.compare_exchange_strong(expansion, Node::EXPANDING,
+                                              std::memory_order_acquire))
+    return expansion == Node::EXPANDED;
+
+  Othello::Bitboard moves = othello.legalMoveMask();
+  int count = bitboard::popcount(moves);
+  if (!moves) {
+    // a pass is a move of its own, unless the opponent is stuck as well
+    Othello passed = othello;
+    passed.doPass();
+    count = passed.legalMoveMask() ? 1 : 0;
+  }
+  std::int64_t first = 0;
+  if (count > 0) {
+    first = tree->allocate(count);
+    if (first < 0) {
+      node.expansion.store(Node::LEAF, std::memory_order_relaxed);
+      return false;
+    }
+    for (int i = 0; i < count; ++i)
+      tree->nodes[first + i].reset(moves ? bitboard::popSquare(moves) : -1);
+  }
+  node.firstChild = static_cast<std::uint32_t>(first);
+  node.childCount = static_cast<std::uint8_t>(count);
+  node.expansion.store(Node::EXPANDED, std::memory_order_release);
+  return true;
+}
+
+int MctsStrategy::playOut(HeuristicFunction heuristic, Othello othello,
+                          std::mt19937 &generator) const {
+  while (true) {
+    const Othello::Bitboard moves = othello.legalMoveMask();
+    if (!moves) {
+      othello.doPass();
+      if (!othello.legalMoveMask())
+        break;
+      continue;
+    }
+    int square = randomSquare(moves, generator);
+    if (playout == Playout::HEURISTIC && (moves & (moves - 1))) {
+      const int other = randomSquare(
+          moves & ~(Othello::Bitboard{1} << square), generator);
+      // the heuristic scores the position for the opponent, lower is better
+      Othello first = othello;
+      first.doMove(moveOn(othello, square));
+      Othello second = othello;
+      second.doMove(moveOn(othello, other));
+      if (heuristic(second) < heuristic(first))
+        square = other;
+    }
+    othello.doMove(moveOn(othello, square));
+  }
+  return othello.blackCount() - othello.whiteCount();
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "Othello.hpp"
+#include "Strategy.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+
+struct SearchProgress;
+
+/**
+ * Monte Carlo tree search: plays out many games from the position and grows
+ * a tree towards the moves that win the most of them, picking the move to
+ * explore next with the UCT formula.
+ *
+ * Several threads can grow the same tree. A thread counts its visit to a
+ * node as soon as it walks through it, as if the playout had been lost,
+ * which steers the other threads elsewhere until the real result comes in.
+ *
+ * The tree of the move that was actually played is kept for the next move,
+ * as long as the strategy is asked about a position two plies or fewer
+ * below the last one.
+ */
+class MctsStrategy : public Strategy {
+public:
+  enum class Playout {
+    /** Plays uniformly random moves, ignores the heuristic */
+    RANDOM,
+    /**
+     * Draws two random moves and plays the one the heuristic prefers, slower
+     * than RANDOM but closer to how the game is actually played
+     */
+    HEURISTIC
+  };
+
+  /**
+   * @param playout
+   * @param threads How many threads grow the tree, 0 for one per core
+   * @param playouts How many games to play out when there are no limits
+   * @param megabytes The memory for the tree, half of it is kept spare to
+   * move the reused part of the tree into. Once the tree fills its half it
+   * stops growing, but the playouts go on.
+   */
+  explicit MctsStrategy(Playout playout = Playout::RANDOM, int threads = 1,
+                        std::uint64_t playouts = 100'000,
+                        std::size_t megabytes = 64);
+
+  AI::Move nextMove(HeuristicFunction heuristic,
+                    const Othello &othello) override;
+
+  /**
+   * Plays out games until the deadline or until maxNodes games were played
+   * out. Limits that set neither play out as many games as when there are
+   * none. The depth limit does not apply.
+   * @param heuristic
+   * @param othello
+   * @param limits
+   * @return The move that was explored the most
+   */
+  AI::Move nextMove(HeuristicFunction heuristic, const Othello &othello,
+                    const SearchLimits &limits) override;
+
+  /**
+   * Grows the tree of the opponent's position, which is kept for the reply
+   * to whichever move the opponent plays
+   * @param heuristic
+   * @param othello
+   * @param stopToken
+   */
+  void ponder(HeuristicFunction heuristic, const Othello &othello,
+              std::stop_token stopToken) override;
+
+  /**
+   * Plays out games as nextMove does, then scores every move by the share
+   * of its playouts it won, so all scores are exact as far as the playouts
+   * tell and the margin does not apply. A move that no playout tried yet
+   * scores 0.
+   * @param heuristic
+   * @param othello
+   * @param limits
+   * @param margin
+   * @return
+   */
+  std::vector<MoveScore> analyze(HeuristicFunction heuristic,
+                                 const Othello &othello,
+                                 const SearchLimits &limits,
+                                 double margin) override;
+
+  /**
+   * @return The games played out by the last search, over all its threads
+   */
+  [[nodiscard]] std::uint64_t playoutCount() const { return playoutsDone; }
+
+  /**
+   * @return The nodes of the tree, including the ones kept from the search
+   * before
+   */
+  [[nodiscard]] std::size_t treeSize() const;
+
+private:
+  struct Node;
+
+  /**
+   * Where the tree lives. Children of a node are allocated together, so a
+   * node only needs to know where the first of them is.
+   */
+  struct Pool {
+    explicit Pool(std::size_t capacity);
+
+    ~Pool();
+
+    /**
+     * @return The index of the first of count new nodes, or -1 when the pool
+     * is full
+     */
+    std::int64_t allocate(int count);
+
+    std::unique_ptr<Node[]> nodes;
+    const std::size_t capacity;
+    std::atomic_size_t used = 0;
+  };
+
+  /**
+   * Makes the tree start at the given position, keeping what it knows about
+   * it when the position is close enough below the old root
+   * @param othello
+   */
+  void reroot(const Othello &othello);
+
+  /**
+   * Moves the subtree of the given node to the spare pool, which then
+   * becomes the tree
+   * @param node
+   */
+  void keepSubtree(std::uint32_t node);
+
+  /**
+   * Plays out games from the position until the budget or the limits run
+   * out, reporting progress to the limits now and then
+   * @param heuristic
+   * @param othello
+   * @param limits
+   * @param budget The number of games to play out
+   * @param scoreMoves Whether to report the scores of all moves
+   */
+  void grow(HeuristicFunction heuristic, const Othello &othello,
+            const SearchLimits &limits, std::uint64_t budget,
+            bool scoreMoves = false);
+
+  /**
+   * @param playouts
+   * @param scoreMoves
+   * @return The line of the moves explored the most, scored by the share of
+   * the playouts its first move won
+   */
+  [[nodiscard]] SearchProgress progress(std::uint64_t playouts,
+                                        bool scoreMoves) const;
+
+  /**
+   * @param node
+   * @return The line starting with the move to the node and going on with
+   * the moves explored the most, scored by the share of the playouts the
+   * move won
+   */
+  [[nodiscard]] PrincipalVariation lineFrom(const Node &node) const;
+
+  /**
+   * @return The lines of all moves at the root, best first
+   */
+  [[nodiscard]] std::vector<MoveScore> moveScores() const;
+
+  /**
+   * Selects a path down the tree, grows it by a node and plays a game out
+   * from there
+   * @param heuristic
+   * @param generator
+   */
+  void iterate(HeuristicFunction heuristic, std::mt19937 &generator);
+
+  /**
+   * Gives the node its children, unless another thread already does
+   * @param node
+   * @param othello The position of the node
+   * @return Whether the node has children now
+   */
+  bool expand(Node &node, const Othello &othello);
+
+  /**
+   * Plays the game to its end
+   * @param heuristic
+   * @param othello
+   * @param generator
+   * @return The disc difference, from the point of view of black
+   */
+  int playOut(HeuristicFunction heuristic, Othello othello,
+              std::mt19937 &generator) const;
+
+  const Playout playout;
+  const int threads;
+  const std::uint64_t playouts;
+  std::unique_ptr<Pool> tree;
+  std::unique_ptr<Pool> spare;
+  /** The position at the root of the tree, none before the first search */
+  std::optional<Othello> rootPosition;
+  /** The heuristic the tree was grown with, it is only reused with the same */
+  HeuristicFunction treeHeuristic = nullptr;
+  std::uint64_t playoutsDone = 0;
+};
@@ -1,64 +1,783 @@
 #include "MinMaxStrategy.hpp"
 #include "Exception.hpp"
+#include "KillerHistoryOrderer.hpp"
+#include "MoveOrderer.hpp"
 #include "Othello.hpp"
+#include "SearchProgress.hpp"
+#include "TranspositionTable.hpp"
+#include "WorkStealingPool.hpp"
+#include "gameOverScore.hpp"
+#include "util/allocation_counter.hpp"
 #include "util/define_logger.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
 
 DEFINE_LOGGER(MinMaxStrategy)
 
-struct MinMaxStrategy::Node {
-  Othello othello;
-  AI::Move move;
-  double score;
+namespace {
+/**
+ * YOUNG_BROTHERS_WAIT only hands out siblings this many plies above the
+ * leaves, shallower subtrees are not worth the bookkeeping
+ */
+constexpr int minimumSplitDepth = 3;
+
+/**
+ * The width of the window PRINCIPAL_VARIATION tests the later moves with.
+ * Scores closer than this to the best so far count as no better.
+ */
+constexpr double nullWindow = 0.01;
+
+/**
+ * How far PRINCIPAL_VARIATION expects the score of an iteration to be from
+ * the one two plies shallower, the window grows fourfold every time it is
+ * wrong
+ */
+constexpr double aspirationWindow = 64;
+
+/**
+ * How many nodes a thread searches between reading the clock and adding its
+ * nodes to the total of the search
+ */
+constexpr std::uint64_t checkInterval = 1024;
+
+/** The table ALPHA_BETA allocates when it is not handed one */
+constexpr std::size_t defaultTableMegabytes = 64;
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+
+int coreCount() {
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+/**
+ * Puts the best move first, and exact scores before bounds that are as high
+ */
+void sortBestFirst(std::vector<MoveScore> &scores) {
+  std::ranges::stable_sort(scores, std::greater{}, [](const MoveScore &score) {
+    return std::pair{score.principalVariation.score,
+                     score.bound == MoveScore::Bound::EXACT};
+  });
+}
+} // namespace
+
+/**
+ * The principal variation below a node
+ */
+struct MinMaxStrategy::Line {
+  /** Room for every move of a game with a pass before each of them */
+  static constexpr int capacity = 2 * Othello::boardSize * Othello::boardSize;
+
+  /** The squares of the moves, -1 for a pass */
+  std::array<int, capacity> squares;
+  int length = 0;
+
+  /**
+   * Makes this line the given move followed by the rest
+   */
+  void assign(int square, const Line &rest) {
+    squares[0] = square;
+    std::copy_n(rest.squares.begin(), rest.length, squares.begin() + 1);
+    length = rest.length + 1;
+  }
+
+  [[nodiscard]] std::vector<AI::Move> moves() const {
+    std::vector<AI::Move> moves;
+    for (int i = 0; i < length; ++i)
+      moves.push_back(squares[i] < 0
+                          ? AI::Move{-1, -1}
+                          : AI::Move{squares[i] % Othello::boardSize,
+                                     squares[i] / Othello::boardSize});
+    return moves;
+  }
+};
+
+/**
+ * What the search keeps for one ply. The position itself is not copied, the
+ * search makes and takes back moves on a single board.
+ */
+struct MinMaxStrategy::Frame {
+  /**
+   * A move can follow every pass, and the search looks at the frame below
+   * the deepest move
+   */
+  static constexpr int stackSize = Line::capacity + 1;
+  static_assert(MoveOrderer::maxPly >= stackSize,
+                "The orderer needs room for every frame");
+
+  LegalMoves legalMoves;
+  MoveOrderer::Order order;
+  /** The principal variation below this ply */
+  Line line;
+};
+
+/**
+ * One completed iteration of deepen
+ */
+struct MinMaxStrategy::Iteration {
+  Line line;
+  double score = 0;
+  int depth = 0;
+};
+
+/**
+ * Shared by every thread of a YOUNG_BROTHERS_WAIT search
+ */
+struct MinMaxStrategy::SplitContext {
+  /**
+   * @param threads
+   * @param stacks The stacks of the strategy, one list for each thread
+   */
+  SplitContext(int threads,
+               std::vector<std::vector<std::unique_ptr<Frame[]>>> &stacks)
+      : pool{threads}, stacks{stacks}, taken(threads) {
+    // the main search already uses the first stack of the calling thread
+    taken[0] = 1;
+  }
+
+  /**
+   * A thread only starts on another sibling while it waits in the middle of
+   * one, so it gives its stacks back in the opposite order it took them
+   * @return A stack for a sibling searched by the calling thread, allocated
+   * only when the thread is deeper in siblings than it ever was
+   */
+  Frame *takeStack() {
+    const int thread = pool.threadIndex();
+    std::vector<std::unique_ptr<Frame[]>> &own = stacks[thread];
+    if (taken[thread] == static_cast<int>(own.size()))
+      own.push_back(std::make_unique<Frame[]>(Frame::stackSize));
+    return own[taken[thread]++].get();
+  }
+
+  void giveBackStack() { --taken[pool.threadIndex()]; }
+
+  WorkStealingPool pool;
+  std::vector<std::vector<std::unique_ptr<Frame[]>>> &stacks;
+  /** How many of its stacks each thread is using */
+  std::vector<int> taken;
+  std::atomic_uint64_t splits = 0;
+  std::atomic_uint64_t tasks = 0;
+  std::atomic_uint64_t cutoffs = 0;
 };
 
-MinMaxStrategy::MinMaxStrategy(int maxDepth) : maxDepth{maxDepth} {}
+/**
+ * A node whose younger siblings are being searched in parallel
+ */
+struct MinMaxStrategy::SplitPoint {
+  /** The split point this node sits below, if any */
+  const SplitPoint *const parent;
+  const double beta;
+  std::mutex mutex;
+  double alpha;
+  ScoredMove best;
+  /** Whether a sibling failed high, which makes the others pointless */
+  std::atomic_bool cutoff = false;
+  /** Whether a sibling ran out of limits, which leaves best incomplete */
+  bool aborted = false;
+
+  /**
+   * @return Whether this node or one above it already has a cutoff
+   */
+  [[nodiscard]] bool cancelled() const {
+    for (const SplitPoint *splitPoint = this; splitPoint;
+         splitPoint = splitPoint->parent)
+      if (splitPoint->cutoff.load(std::memory_order_relaxed))
+        return true;
+    return false;
+  }
+};
+
+/**
+ * What one thread needs to know about its search
+ */
+struct MinMaxStrategy::SearchState {
+  const SearchLimits &limits;
+  /**
+   * The nodes of the whole search, over all threads, which the node limit
+   * applies to
+   */
+  std::atomic_uint64_t &searchNodes;
+  const SearchLimits::Clock::time_point start;
+  /** The frames of the thread, indexed by the ply */
+  Frame *const stack;
+  MoveOrderer &orderer;
+  /** Numbers the threads of a parallel search, the main thread is 0 */
+  const int thread = 0;
+  /** Raised by the main thread of a parallel search once it is done */
+  const std::atomic_bool *const finished = nullptr;
+  /** Set when siblings may be handed out to other threads */
+  SplitContext *const context = nullptr;
+  /** The split point the search runs below, if any */
+  const SplitPoint *const splitPoint = nullptr;
+  /** The nodes of this state alone */
+  std::uint64_t nodes = 0;
+  /** The part of nodes already added to searchNodes */
+  std::uint64_t flushed = 0;
+  /** The node at which stop looks at the limits next */
+  std::uint64_t nextCheck = 1;
+  /** The heap allocations of the search, which has no need for any */
+  std::uint64_t allocations = 0;
+  /**
+   * The main thread always completes its first iteration, so there is a
+   * move to play
+   */
+  bool abortable = false;
+  bool aborted = false;
+
+  /**
+   * Adds the nodes counted since the last call to the total of the search
+   * @return The total, as far as the other threads added theirs
+   */
+  std::uint64_t flush() {
+    const std::uint64_t counted = nodes - flushed;
+    flushed = nodes;
+    return searchNodes.fetch_add(counted, std::memory_order_relaxed) + counted;
+  }
+
+  /**
+   * Counts a node and checks the limits, reading the clock and the other
+   * threads only on the first node and once every checkInterval nodes
+   * after that, or sooner when the nodes left to the search run out
+   * before. Cutoffs at split points are checked on every node.
+   * @return Whether the search has to stop
+   */
+  bool stop() {
+    ++nodes;
+    if (!aborted && splitPoint && splitPoint->cancelled())
+      aborted = true;
+    if (nodes >= nextCheck) {
+      const std::uint64_t total = flush();
+      const std::uint64_t left =
+          total < limits.maxNodes ? limits.maxNodes - total : 1;
+      nextCheck = nodes + std::min(checkInterval, left);
+      if (abortable && !aborted &&
+          (total >= limits.maxNodes ||
+           (finished && finished->load(std::memory_order_relaxed)) ||
+           limits.stopToken.stop_requested() ||
+           (limits.deadline &&
+            SearchLimits::Clock::now() >= *limits.deadline)))
+        aborted = true;
+    }
+    return aborted;
+  }
+};
+
+MinMaxStrategy::MinMaxStrategy(int maxDepth, Search search, int threads,
+                               std::shared_ptr<TranspositionTable> table,
+                               const OrdererFactory &ordererFactory)
+    : maxDepth{maxDepth}, search{search},
+      threads{threads > 0 ? threads : coreCount()},
+      table{table || search == Search::MINIMAX
+                ? std::move(table)
+                : std::make_shared<TranspositionTable>(defaultTableMegabytes)},
+      stacks(search == Search::MINIMAX ? 1 : this->threads) {
+  orderers.reserve(stacks.size());
+  for (std::vector<std::unique_ptr<Frame[]>> &threadStacks : stacks) {
+    threadStacks.push_back(std::make_unique<Frame[]>(Frame::stackSize));
+    // the threads of YOUNG_BROTHERS_WAIT share their nodes, so they had
+    // better agree on the order
+    const int thread =
+        search == Search::LAZY_SMP ? static_cast<int>(orderers.size()) : 0;
+    orderers.push_back(ordererFactory
+                           ? ordererFactory(thread)
+                           : std::make_unique<KillerHistoryOrderer>(thread));
+  }
+}
+
+MinMaxStrategy::~MinMaxStrategy() = default;
 
 AI::Move MinMaxStrategy::nextMove(HeuristicFunction heuristic,
                                   const Othello &othello) {
-  Node origin{.othello = othello,
-              .move = {-1, -1},
-              .score = std::numeric_limits<double>::min()};
-  Node node = minimax(heuristic, origin, 0, true);
-  if (node.move == origin.move)
+  return nextMove(heuristic, othello, SearchLimits::depth(maxDepth));
+}
+
+AI::Move MinMaxStrategy::nextMove(HeuristicFunction heuristic,
+                                  const Othello &othello,
+                                  const SearchLimits &limits) {
+  if (search != Search::MINIMAX) {
+    const SearchLimits::Clock::time_point start = SearchLimits::Clock::now();
+    table->newSearch();
+    for (const std::unique_ptr<MoveOrderer> &orderer : orderers)
+      orderer->newSearch();
+    // once every square is filled there is nothing left to look ahead for
+    const int depthLimit =
+        std::min({maxDepth, limits.maxDepth, othello.emptyCount()});
+
+    std::optional<SplitContext> context;
+    if (search == Search::YOUNG_BROTHERS_WAIT)
+      context.emplace(threads, stacks);
+    std::atomic_bool finished = false;
+    std::atomic_uint64_t searchNodes = 0;
+    std::atomic_uint64_t helperAllocations = 0;
+    std::vector<std::jthread> helpers;
+    if (search == Search::LAZY_SMP)
+      for (int thread = 1; thread < threads; ++thread)
+        helpers.emplace_back([&, thread] {
+          SearchState state{limits,           searchNodes,
+                            start,            stacks[thread].front().get(),
+                            *orderers[thread], thread,
+                            &finished};
+          // every other helper runs one ply ahead of the main thread
+          deepen(heuristic, state, othello, 1 + thread % 2, depthLimit);
+          helperAllocations += state.allocations;
+          state.flush();
+        });
+    SearchState state{limits,
+                      searchNodes,
+                      start,
+                      stacks.front().front().get(),
+                      *orderers.front(),
+                      0,
+                      nullptr,
+                      context ? &*context : nullptr};
+    const Iteration iteration =
+        deepen(heuristic, state, othello, 1, depthLimit);
+    finished = true;
+    helpers.clear();
+    state.flush();
+    nodes = searchNodes;
+    if (context) {
+      lastSplitStats = {.splits = context->splits,
+                        .tasks = context->tasks,
+                        .steals = context->pool.stealCount(),
+                        .cutoffs = context->cutoffs};
+    }
+    // handing siblings to the pool allocates, searching them does not
+    if (search != Search::YOUNG_BROTHERS_WAIT &&
+        state.allocations + helperAllocations > 0)
+      LOG4CPLUS_WARN(GetLogger(), "The search allocated "
+                                      << state.allocations + helperAllocations
+                                      << " times");
+
+    lastPrincipalVariation = {.moves = iteration.line.moves(),
+                              .score = iteration.score,
+                              .depth = iteration.depth};
+    const std::vector<AI::Move> &moves = lastPrincipalVariation.moves;
+    if (moves.empty() || moves.front().first < 0)
+      THROW_SIMPLE_EXCEPTION("No move was selected");
+    LOG4CPLUS_DEBUG(GetLogger(), "Depth " << lastPrincipalVariation.depth
+                                          << ", score "
+                                          << lastPrincipalVariation.score
+                                          << ", " << nodes << " nodes: "
+                                          << lastPrincipalVariation);
+    return moves.front();
+  }
+
+  Othello position = othello;
+  int square = -1;
+  minimax(heuristic, position, stacks.front().front().get(), 0, true,
+          &square);
+  if (square < 0)
     THROW_SIMPLE_EXCEPTION("No move was selected");
-  return node.move;
+  const AI::Move move{square % Othello::boardSize,
+                      square / Othello::boardSize};
+  lastPrincipalVariation = {.moves = {move}, .depth = maxDepth};
+  return move;
+}
+
+void MinMaxStrategy::ponder(HeuristicFunction heuristic,
+                            const Othello &othello,
+                            std::stop_token stopToken) {
+  if (search == Search::MINIMAX)
+    return;
+  const SearchLimits limits{.stopToken = std::move(stopToken)};
+  // the last search left the reply it expects in the table, and that is
+  // the one usually played
+  if (const std::optional entry = table->probe(othello.hash());
+      entry && entry->move >= 0) {
+    Othello expected = othello;
+    const LegalMoves legalMoves = othello.legalMoves();
+    const auto reply = legalMoves.find(entry->move % Othello::boardSize,
+                                       entry->move / Othello::boardSize);
+    if (reply != legalMoves.end()) {
+      expected.doMove(*reply);
+      if (expected.legalMoveMask())
+        nextMove(heuristic, expected, limits);
+    }
+  }
+  // whatever time is left goes to all replies at once
+  if (!limits.stopToken.stop_requested())
+    nextMove(heuristic, othello, limits);
+}
+
+std::vector<MoveScore> MinMaxStrategy::analyze(HeuristicFunction heuristic,
+                                               const Othello &othello,
+                                               const SearchLimits &limits,
+                                               double margin) {
+  const LegalMoves legalMoves = othello.legalMoves();
+  if (legalMoves.empty())
+    return {};
+  std::vector<MoveScore> scores(legalMoves.size());
+  for (int i = 0; i < legalMoves.size(); ++i)
+    scores[i].principalVariation.moves = {
+        {legalMoves[i].x(), legalMoves[i].y()}};
+
+  if (search == Search::MINIMAX) {
+    for (int i = 0; i < legalMoves.size(); ++i) {
+      Othello position = othello;
+      position.doMove(legalMoves[i]);
+      if (!position.legalMoveMask())
+        position.doPass();
+      const bool goAgain = othello.isBlackTurn() == position.isBlackTurn();
+      PrincipalVariation &line = scores[i].principalVariation;
+      line.score = minimax(heuristic, position, stacks.front().front().get(),
+                           1, goAgain);
+      line.depth = maxDepth;
+    }
+    sortBestFirst(scores);
+    lastPrincipalVariation = scores.front().principalVariation;
+    return scores;
+  }
+
+  const SearchLimits::Clock::time_point start = SearchLimits::Clock::now();
+  table->newSearch();
+  for (const std::unique_ptr<MoveOrderer> &orderer : orderers)
+    orderer->newSearch();
+  const int depthLimit =
+      std::min({maxDepth, limits.maxDepth, othello.emptyCount()});
+  WorkStealingPool pool{threads};
+  std::atomic_uint64_t searchNodes = 0;
+  std::vector<int> order(legalMoves.size());
+  std::iota(order.begin(), order.end(), 0);
+  // scores at different depths don't compare, so an iteration only
+  // replaces the scores once every move of it is done
+  std::vector<MoveScore> iterationScores;
+  for (int depth = 1; depth <= depthLimit; ++depth) {
+    std::ranges::stable_sort(order, std::greater{}, [&](int i) {
+      return scores[i].principalVariation.score;
+    });
+    iterationScores = scores;
+    std::mutex mutex;
+    double best = -infinity;
+    bool aborted = false;
+    WorkStealingPool::Group group;
+    // this thread takes back its newest task first, so queue the best last
+    for (auto index = order.rbegin(); index != order.rend(); ++index)
+      pool.submit(group, [&, depth, i = *index] {
+        const int thread = pool.threadIndex();
+        // a thread searches one move at a time, so its stack is free
+        Frame *const stack = stacks[thread].front().get();
+        SearchState state{limits, searchNodes,      start,
+                          stack,  *orderers[thread], thread};
+        // the first iteration always completes, so every move has a score
+        state.abortable = depth > 1;
+        double alpha;
+        {
+          const std::lock_guard lock{mutex};
+          alpha = best - margin;
+        }
+        Othello position = othello;
+        position.doMove(legalMoves[i]);
+        Line &rest = stack[1].line;
+        const double score = -alphaBeta(heuristic, state, position, depth - 1,
+                                        1, -infinity, -alpha, false, &rest)
+                                  .score;
+        state.flush();
+
+        const std::lock_guard lock{mutex};
+        if (state.aborted) {
+          aborted = true;
+          return;
+        }
+        stack[0].line.assign(legalMoves[i].square, rest);
+        const bool exact = score > alpha;
+        iterationScores[i] = {
+            .principalVariation = {.moves = stack[0].line.moves(),
+                                   .score = score,
+                                   .depth = depth},
+            .bound = exact ? MoveScore::Bound::EXACT
+                           : MoveScore::Bound::UPPER};
+        if (exact)
+          best = std::max(best, score);
+      });
+    pool.wait(group);
+    if (aborted)
+      break;
+    scores.swap(iterationScores);
+
+    if (limits.onProgress) {
+      std::vector<MoveScore> sorted = scores;
+      sortBestFirst(sorted);
+      const PrincipalVariation line = sorted.front().principalVariation;
+      limits.onProgress({.principalVariation = line,
+                         .nodes = searchNodes,
+                         .moveScores = std::move(sorted)});
+    }
+    if (limits.deadline && SearchLimits::Clock::now() - start >
+                               (*limits.deadline - start) / 2)
+      break;
+  }
+  nodes = searchNodes;
+  sortBestFirst(scores);
+  lastPrincipalVariation = scores.front().principalVariation;
+  return scores;
 }
 
-MinMaxStrategy::Node MinMaxStrategy::minimax(HeuristicFunction heuristic,
-                                             const MinMaxStrategy::Node &node,
-                                             int depth, bool maximizingPlayer) {
-  if (depth == maxDepth || node.othello.legalMoves().empty())
-    return node;
-
-  Node value{.othello = node.othello,
-             .move = {-1, -1},
-             .score = maximizingPlayer ? std::numeric_limits<double>::min()
-                                       : std::numeric_limits<double>::max()};
-  for (const auto &[move, capture] : node.othello.legalMoves()) {
-    Node child = makeNode(heuristic, node.othello, move);
-    bool blackTurn = node.othello.isBlackTurn();
-    bool childBlackTurn = child.othello.isBlackTurn();
-    bool goAgain = blackTurn == childBlackTurn;
-    Node opponentChild =
-        minimax(heuristic, child, depth + 1, goAgain == maximizingPlayer);
-    if (maximizingPlayer) {
-      if (opponentChild.score >= value.score)
-        value = opponentChild;
+double MinMaxStrategy::minimax(HeuristicFunction heuristic, Othello &othello,
+                               Frame *stack, int ply, bool maximizingPlayer,
+                               int *bestSquare) {
+  if (ply == maxDepth || !othello.legalMoveMask())
+    return heuristic(othello);
+
+  LegalMoves &legalMoves = stack[ply].legalMoves;
+  othello.legalMoves(legalMoves);
+  double best = maximizingPlayer ? std::numeric_limits<double>::lowest()
+                                 : std::numeric_limits<double>::max();
+  for (const LegalMove &legalMove : legalMoves) {
+    const bool blackTurn = othello.isBlackTurn();
+    const Othello::UndoInfo undoInfo = othello.doMove(legalMove);
+    const bool passed = !othello.legalMoveMask();
+    if (passed)
+      othello.doPass();
+    const bool goAgain = blackTurn == othello.isBlackTurn();
+    const double score = minimax(heuristic, othello, stack, ply + 1,
+                                 goAgain == maximizingPlayer);
+    if (passed)
+      othello.doPass();
+    othello.undoMove(undoInfo);
+    // ties go to the later move
+    if (maximizingPlayer ? score >= best : score <= best) {
+      best = score;
+      if (bestSquare)
+        *bestSquare = legalMove.square;
+    }
+  }
+  return best;
+}
+
+MinMaxStrategy::Iteration MinMaxStrategy::deepen(HeuristicFunction heuristic,
+                                                 SearchState &state,
+                                                 const Othello &othello,
+                                                 int firstDepth,
+                                                 int lastDepth) {
+  Othello position = othello;
+  Iteration iteration;
+  Line &line = state.stack[0].line;
+  // the side that moves last tends to look better, so scores swing between
+  // odd and even depths and only the same parity makes a good guess
+  std::array<std::optional<double>, 2> scoreByParity;
+  const auto searchRoot = [&](int depth, double alpha, double beta) {
+    const std::uint64_t allocations = util::threadAllocationCount();
+    const ScoredMove best = alphaBeta(heuristic, state, position, depth, 0,
+                                      alpha, beta, true, &line);
+    state.allocations += util::threadAllocationCount() - allocations;
+    return best;
+  };
+  for (int depth = firstDepth; depth <= lastDepth; ++depth) {
+    state.abortable = state.thread != 0 || depth > firstDepth;
+    std::optional<double> &guess = scoreByParity[depth % 2];
+    double alpha = -infinity;
+    double beta = infinity;
+    double window = aspirationWindow;
+    if (search == Search::PRINCIPAL_VARIATION && guess) {
+      alpha = *guess - window;
+      beta = *guess + window;
+    }
+    ScoredMove best = searchRoot(depth, alpha, beta);
+    while (!state.aborted && (best.score <= alpha || best.score >= beta)) {
+      // only a bound came back, widen the window on the side it failed
+      window *= 4;
+      if (best.score <= alpha)
+        alpha = window < winScore ? best.score - window : -infinity;
+      else
+        beta = window < winScore ? best.score + window : infinity;
+      best = searchRoot(depth, alpha, beta);
+    }
+    if (state.aborted)
+      break;
+    guess = best.score;
+    iteration = {.line = line, .score = best.score, .depth = depth};
+    if (state.thread == 0 && state.limits.onProgress)
+      state.limits.onProgress(
+          {.principalVariation = {.moves = line.moves(),
+                                  .score = best.score,
+                                  .depth = depth},
+           .nodes = state.flush()});
+    // the next iteration takes several times as long as this one, don't
+    // start it when it has no chance to finish
+    if (state.limits.deadline &&
+        SearchLimits::Clock::now() - state.start >
+            (*state.limits.deadline - state.start) / 2)
+      break;
+  }
+  return iteration;
+}
+
+MinMaxStrategy::ScoredMove
+MinMaxStrategy::alphaBeta(HeuristicFunction heuristic, SearchState &state,
+                          Othello &othello, int depth, int ply, double alpha,
+                          double beta, bool root, Line *line) {
+  if (line)
+    line->length = 0;
+  if (state.stop())
+    return {0, -1};
+  if (depth == 0 && othello.legalMoveMask())
+    return {heuristic(othello), -1};
+
+  using Bound = TranspositionTable::Bound;
+  const double originalAlpha = alpha;
+  int hashMove = -1;
+  if (const std::optional entry = table->probe(othello.hash())) {
+    hashMove = entry->move;
+    // the root has to come up with a move, so it always searches
+    if (!root && entry->depth >= depth &&
+        (entry->bound == Bound::EXACT ||
+         (entry->bound == Bound::LOWER && entry->score >= beta) ||
+         (entry->bound == Bound::UPPER && entry->score <= alpha)))
+      return {entry->score, entry->move};
+  }
+
+  Frame &frame = state.stack[ply];
+  Line *const rest = line ? &state.stack[ply + 1].line : nullptr;
+  const LegalMoves &legalMoves = frame.legalMoves;
+  othello.legalMoves(frame.legalMoves);
+  if (legalMoves.empty()) {
+    othello.doPass();
+    const bool gameOver = !othello.legalMoveMask();
+    const double score =
+        gameOver ? -gameOverScore(othello)
+                 : -alphaBeta(heuristic, state, othello, depth, ply + 1, -beta,
+                              -alpha, false, rest)
+                        .score;
+    othello.doPass();
+    if (line && !gameOver)
+      line->assign(-1, *rest);
+    return {score, -1};
+  }
+
+  const MoveOrderer::Order &order = frame.order;
+  state.orderer.order(heuristic, othello, legalMoves,
+                      root ? othello.distinctMoveMask() : legalMoves.mask(),
+                      hashMove, ply, depth, frame.order);
+  ScoredMove best{-infinity, -1};
+  for (int i = 0; i < order.size; ++i) {
+    // the eldest brother is searched first, for a bound worth sharing
+    if (i == 1 && state.context && depth >= minimumSplitDepth) {
+      const std::span<const int> siblings{order.indices.begin() + 1,
+                                          order.indices.begin() + order.size};
+      best = searchSiblings(heuristic, state, othello, legalMoves, siblings,
+                            depth, ply, alpha, beta, best, line);
+      if (state.aborted)
+        return best;
+      break;
+    }
+    const LegalMove &move = legalMoves[order.indices[i]];
+    const Othello::UndoInfo undoInfo = othello.doMove(move);
+    double score;
+    if (search == Search::PRINCIPAL_VARIATION && i > 0) {
+      // the later moves are expected to be worse, asking whether they beat
+      // alpha prunes much more than asking for their score
+      if (rest)
+        rest->length = 0;
+      score = -alphaBeta(heuristic, state, othello, depth - 1, ply + 1,
+                         -alpha - nullWindow, -alpha)
+                   .score;
+      if (line && score > alpha && score < beta && !state.aborted)
+        score = -alphaBeta(heuristic, state, othello, depth - 1, ply + 1,
+                           -beta, -alpha, false, rest)
+                     .score;
     } else {
-      if (opponentChild.score <= value.score)
-        value = opponentChild;
+      score = -alphaBeta(heuristic, state, othello, depth - 1, ply + 1, -beta,
+                         -alpha, false, rest)
+                   .score;
+    }
+    othello.undoMove(undoInfo);
+    if (state.aborted)
+      return best;
+    if (score > best.score) {
+      best = {score, move.square};
+      if (line)
+        line->assign(move.square, *rest);
+    }
+    alpha = std::max(alpha, score);
+    if (alpha >= beta) {
+      state.orderer.cutoff(othello, move.square, ply, depth);
+      break;
     }
   }
-  if (depth > 0)
-    value.move = node.move;
-  return value;
+  const Bound bound = best.score <= originalAlpha ? Bound::UPPER
+                      : best.score >= beta        ? Bound::LOWER
+                                                  : Bound::EXACT;
+  table->store(othello.hash(), {.score = best.score,
+                                .move = best.square,
+                                .depth = depth,
+                                .bound = bound});
+  return best;
 }
 
-MinMaxStrategy::Node MinMaxStrategy::makeNode(HeuristicFunction heuristic,
-                                              const Othello &othello,
-                                              AI::Move move) {
-  Node node{.othello = othello, .move = move};
-  node.othello.placePiece(move.first, move.second);
-  node.score = heuristic(node.othello);
-  return node;
+MinMaxStrategy::ScoredMove MinMaxStrategy::searchSiblings(
+    HeuristicFunction heuristic, SearchState &state, const Othello &othello,
+    const LegalMoves &legalMoves, std::span<const int> siblings, int depth,
+    int ply, double alpha, double beta, ScoredMove best, Line *line) {
+  SplitContext &context = *state.context;
+  SplitPoint splitPoint{state.splitPoint, beta, {}, alpha, best};
+  ++context.splits;
+  WorkStealingPool::Group group;
+  // this thread takes back its newest task first, so queue the best last
+  for (auto sibling = siblings.rbegin(); sibling != siblings.rend();
+       ++sibling) {
+    const LegalMove &move = legalMoves[*sibling];
+    context.pool.submit(group, [&, move] {
+      if (splitPoint.cancelled())
+        return;
+      ++context.tasks;
+      Frame *const stack = context.takeStack();
+      MoveOrderer &orderer = *orderers[context.pool.threadIndex()];
+      SearchState siblingState{state.limits,   state.searchNodes,
+                               state.start,    stack,
+                               orderer,        state.thread,
+                               state.finished, &context,
+                               &splitPoint};
+      siblingState.abortable = state.abortable;
+      double siblingAlpha;
+      {
+        const std::lock_guard lock{splitPoint.mutex};
+        siblingAlpha = splitPoint.alpha;
+      }
+      // the position is left alone until every sibling is done
+      Othello position = othello;
+      position.doMove(move);
+      // the frames above the sibling stay unused, so that the orderer sees
+      // the same plies as in the serial search
+      Line &rest = stack[ply + 1].line;
+      const double score =
+          -alphaBeta(heuristic, siblingState, position, depth - 1, ply + 1,
+                     -beta, -siblingAlpha, false, line ? &rest : nullptr)
+               .score;
+      // nothing else runs on this thread before the line is copied below
+      context.giveBackStack();
+      siblingState.flush();
+
+      const std::lock_guard lock{splitPoint.mutex};
+      if (siblingState.aborted) {
+        splitPoint.aborted |= !splitPoint.cutoff;
+        return;
+      }
+      if (score > splitPoint.best.score) {
+        splitPoint.best = {score, move.square};
+        if (line)
+          line->assign(move.square, rest);
+      }
+      splitPoint.alpha = std::max(splitPoint.alpha, score);
+      if (splitPoint.alpha >= beta && !splitPoint.cutoff) {
+        splitPoint.cutoff = true;
+        ++context.cutoffs;
+        orderer.cutoff(othello, move.square, ply, depth);
+      }
+    });
+  }
+  context.pool.wait(group);
+  if (splitPoint.aborted || (state.splitPoint && state.splitPoint->cancelled()))
+    state.aborted = true;
+  return splitPoint.best;
 }
@@ -1,23 +1,263 @@
 #pragma once
 
+#include "OthelloFwd.hpp"
+#include "PrincipalVariation.hpp"
 #include "Strategy.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+class MoveOrderer;
+
+class TranspositionTable;
 
 class MinMaxStrategy : public Strategy {
 public:
-  explicit MinMaxStrategy(int maxDepth);
+  enum class Search {
+    /** Searches every move, kept as a reference for the faster modes */
+    MINIMAX,
+    /** Negamax with alpha-beta pruning and heuristic move ordering */
+    ALPHA_BETA,
+    /**
+     * ALPHA_BETA on several threads that search the same position and share
+     * what they find through the transposition table. The extra threads run
+     * ahead by a ply or try moves in a different order, so that they fill
+     * the table with results the main thread is about to need.
+     */
+    LAZY_SMP,
+    /**
+     * ALPHA_BETA that searches the first move of a node on its own, then
+     * hands the remaining moves to a work stealing pool. Waiting for the
+     * first move gives the others a bound to prune with, so the parallel
+     * search visits about the same tree as the serial one.
+     */
+    YOUNG_BROTHERS_WAIT,
+    /**
+     * ALPHA_BETA that only asks whether the moves after the first beat it,
+     * with a window too narrow to hold any score in between, and searches a
+     * move again with the full window when it does. Each iteration starts
+     * with a narrow window around the score of the one before, widened
+     * whenever the score falls outside.
+     */
+    PRINCIPAL_VARIATION
+  };
+
+  /**
+   * Makes the move orderer of one thread. The number of the thread lets
+   * the threads of LAZY_SMP order moves differently, it is 0 for every
+   * thread of the other searches, whose threads share their nodes and had
+   * better agree on the order.
+   */
+  using OrdererFactory = std::function<std::unique_ptr<MoveOrderer>(int)>;
+
+  /**
+   * What YOUNG_BROTHERS_WAIT did to spread its last search over threads
+   */
+  struct SplitStats {
+    /** Nodes whose younger siblings were handed out */
+    std::uint64_t splits;
+    /** Siblings that were searched, not skipped after a cutoff */
+    std::uint64_t tasks;
+    /** Siblings searched by another thread than the one that handed them out */
+    std::uint64_t steals;
+    /** Split points where a sibling failed high */
+    std::uint64_t cutoffs;
+  };
+
+  /**
+   * @param maxDepth The deepest search, even when the limits allow more
+   * @param search
+   * @param threads How many threads LAZY_SMP and YOUNG_BROTHERS_WAIT search
+   * with, and every search but MINIMAX analyzes with, 0 for one per core
+   * @param table Where ALPHA_BETA and LAZY_SMP cache results, pass the same
+   * table to strategies that should share them. Strategies scoring positions
+   * with different heuristics must not share a table. When left empty the
+   * strategy allocates a table of its own.
+   * @param ordererFactory Makes the move orderer of every thread, when left
+   * empty every thread gets a KillerHistoryOrderer. MINIMAX searches every
+   * move anyway and orders none.
+   */
+  explicit MinMaxStrategy(int maxDepth, Search search = Search::MINIMAX,
+                          int threads = 1,
+                          std::shared_ptr<TranspositionTable> table = nullptr,
+                          const OrdererFactory &ordererFactory = {});
+
+  ~MinMaxStrategy() override;
 
   AI::Move nextMove(HeuristicFunction heuristic,
                     const Othello &othello) override;
 
+  /**
+   * ALPHA_BETA deepens one ply at a time until it reaches a limit, and plays
+   * the best move of the last iteration it completed. MINIMAX cannot stop
+   * early and always searches to the depth given to the constructor.
+   * @param heuristic
+   * @param othello
+   * @param limits
+   * @return
+   */
+  AI::Move nextMove(HeuristicFunction heuristic, const Othello &othello,
+                    const SearchLimits &limits) override;
+
+  /**
+   * Searches the position after the reply the last search expects, as if
+   * it was played, then the opponent's position itself, which leaves the
+   * scores of all replies in the transposition table. MINIMAX keeps nothing
+   * and returns right away.
+   * @param heuristic
+   * @param othello
+   * @param stopToken
+   */
+  void ponder(HeuristicFunction heuristic, const Othello &othello,
+              std::stop_token stopToken) override;
+
+  /**
+   * Deepens all root moves together, one ply at a time, and hands them out
+   * to threads best first, so that the margin soon has a bound to prune the
+   * others with. The threads only split the root. When the limits run out
+   * in the middle of an iteration, all moves keep the scores of the last
+   * iteration that completed, since scores of different depths do not
+   * compare. The node limit applies to all moves together. MINIMAX
+   * searches the moves one after the other to the depth given to the
+   * constructor and scores them all exactly.
+   * @param heuristic
+   * @param othello
+   * @param limits
+   * @param margin
+   * @return
+   */
+  std::vector<MoveScore> analyze(HeuristicFunction heuristic,
+                                 const Othello &othello,
+                                 const SearchLimits &limits,
+                                 double margin) override;
+
+  /**
+   * @return The positions the last search visited, over all its threads
+   */
+  [[nodiscard]] std::uint64_t nodeCount() const { return nodes; }
+
+  [[nodiscard]] const SplitStats &splitStats() const { return lastSplitStats; }
+
+  /**
+   * @return The line the last search expects, starting with the move it
+   * played. MINIMAX only reports that move. The line ends early where the
+   * transposition table already knew the score of a position.
+   */
+  [[nodiscard]] const PrincipalVariation &principalVariation() const {
+    return lastPrincipalVariation;
+  }
+
 private:
-  struct Node;
+  struct Line;
+
+  struct Frame;
+
+  struct Iteration;
+
+  struct SearchState;
+
+  struct SplitContext;
+
+  struct SplitPoint;
+
+  /**
+   * The result of a search: its score for the side to move and the square of
+   * the move that achieves it, -1 when no move was searched
+   */
+  struct ScoredMove {
+    double score;
+    int square;
+  };
+
+  /**
+   * Searches every move to maxDepth, the position is restored before
+   * returning
+   * @param heuristic
+   * @param othello The position after the move that led here, and after a
+   * pass when the side to move had no moves
+   * @param stack The frames to keep the legal moves in, one per ply
+   * @param ply
+   * @param maximizingPlayer
+   * @param bestSquare Where to put the square of the best move, only passed
+   * at the root
+   * @return The score of the leaf the best line ends in
+   */
+  double minimax(HeuristicFunction heuristic, Othello &othello, Frame *stack,
+                 int ply, bool maximizingPlayer, int *bestSquare = nullptr);
+
+  /**
+   * Searches deeper and deeper until the limits run out
+   * @param heuristic
+   * @param state
+   * @param othello
+   * @param firstDepth
+   * @param lastDepth
+   * @return The last completed iteration, with an empty line if none
+   * completed
+   */
+  Iteration deepen(HeuristicFunction heuristic, SearchState &state,
+                   const Othello &othello, int firstDepth, int lastDepth);
 
-  MinMaxStrategy::Node minimax(HeuristicFunction heuristic,
-                               const MinMaxStrategy::Node &node, int depth,
-                               bool maximizingPlayer);
+  /**
+   * Searches the position in place, it is restored before returning. Once
+   * the search runs out of limits it returns right away, and the results it
+   * returns from then on are meaningless.
+   * @param heuristic Scores positions for the side to move
+   * @param state Counts the nodes and tracks the limits
+   * @param othello
+   * @param depth The number of plies left, passes are free
+   * @param ply How far the position is from the root, which picks its frame
+   * of the stack in state
+   * @param alpha The score the side to move is already guaranteed
+   * @param beta The score above which the opponent avoids this position
+   * @param root Whether to skip moves that are symmetric to another one
+   * @param line Where to put the principal variation, if it is wanted
+   * @return
+   */
+  ScoredMove alphaBeta(HeuristicFunction heuristic, SearchState &state,
+                       Othello &othello, int depth, int ply, double alpha,
+                       double beta, bool root = false, Line *line = nullptr);
 
-  static MinMaxStrategy::Node makeNode(HeuristicFunction heuristic,
-                                       const Othello &othello, AI::Move move);
+  /**
+   * Searches the younger siblings of a node in parallel, the calling thread
+   * takes part until all of them are done
+   * @param heuristic
+   * @param state The state of the thread that searched the eldest sibling
+   * @param othello The position of the node
+   * @param legalMoves
+   * @param siblings The indices of the moves to search, best first
+   * @param depth
+   * @param ply
+   * @param alpha
+   * @param beta
+   * @param best What the eldest sibling scored
+   * @param line The principal variation of the eldest sibling, replaced by
+   * the one of the best sibling
+   * @return The best of all siblings
+   */
+  ScoredMove searchSiblings(HeuristicFunction heuristic, SearchState &state,
+                            const Othello &othello,
+                            const LegalMoves &legalMoves,
+                            std::span<const int> siblings, int depth, int ply,
+                            double alpha, double beta, ScoredMove best,
+                            Line *line);
 
   const int maxDepth;
+  const Search search;
+  const int threads;
+  const std::shared_ptr<TranspositionTable> table;
+  std::uint64_t nodes = 0;
+  SplitStats lastSplitStats{};
+  PrincipalVariation lastPrincipalVariation;
+  /**
+   * The frames each thread searches with, allocated up front so that the
+   * search itself never allocates. Every thread has a stack of its own, and
+   * YOUNG_BROTHERS_WAIT adds one for every sibling a thread searches while
+   * it waits in the middle of another.
+   */
+  std::vector<std::vector<std::unique_ptr<Frame[]>>> stacks;
+  /** One for every thread, which learns from the cutoffs it finds */
+  std::vector<std::unique_ptr<MoveOrderer>> orderers;
 };
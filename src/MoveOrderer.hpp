@@ -0,0 +1,60 @@
+#pragma once
+
+#include "HeuristicFunction.hpp"
+#include "Othello.hpp"
+#include <array>
+
+/**
+ * Decides which moves MinMaxStrategy searches first, best first. The
+ * better the first move, the more alpha-beta prunes from the rest.
+ *
+ * The search tells the orderer about every cutoff, so an orderer can learn
+ * from them. Every thread of a search has an orderer of its own.
+ */
+class MoveOrderer {
+public:
+  using Bitboard = Othello::Bitboard;
+
+  /** Room for every ply of a game with a pass before each move */
+  static constexpr int maxPly = 2 * Othello::boardSize * Othello::boardSize + 1;
+
+  /**
+   * Indices into a LegalMoves, best first
+   */
+  struct Order {
+    std::array<int, LegalMoves::capacity> indices;
+    int size = 0;
+  };
+
+  virtual ~MoveOrderer() = default;
+
+  /**
+   * Called before every search, whose root may have nothing to do with the
+   * one before
+   */
+  virtual void newSearch() = 0;
+
+  /**
+   * @param heuristic Scores positions for the side to move
+   * @param othello The position, restored before returning
+   * @param legalMoves
+   * @param allowed The moves to put in the order, the others are left out
+   * @param hashMove The move the transposition table suggests, -1 for none
+   * @param ply How far the position is from the root
+   * @param depth The plies left to search below the position
+   * @param order Where to put the order
+   */
+  virtual void order(HeuristicFunction heuristic, Othello &othello,
+                     const LegalMoves &legalMoves, Bitboard allowed,
+                     int hashMove, int ply, int depth, Order &order) = 0;
+
+  /**
+   * Tells the orderer about a move that refuted the position
+   * @param othello The position the move was played in
+   * @param square
+   * @param ply
+   * @param depth The plies that were left below the position
+   */
+  virtual void cutoff(const Othello &othello, int square, int ply,
+                      int depth) = 0;
+};
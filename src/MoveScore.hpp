@@ -0,0 +1,29 @@
+#pragma once
+
+#include "PrincipalVariation.hpp"
+
+/**
+ * What an analysis found out about one legal move of a position
+ */
+struct MoveScore {
+  enum class Bound {
+    /** The score is exact at the depth of the line */
+    EXACT,
+    /**
+     * The move is worth at most the score, the analysis stopped searching it
+     * once it was clearly worse than the best
+     */
+    UPPER
+  };
+
+  /**
+   * The line starting with the move. Its score is for the side to move in
+   * the analyzed position, in the units of whatever searched it.
+   */
+  PrincipalVariation principalVariation;
+  Bound bound = Bound::EXACT;
+
+  [[nodiscard]] const AI::Move &move() const {
+    return principalVariation.moves.front();
+  }
+};
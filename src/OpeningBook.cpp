@@ -0,0 +1,156 @@
+#include "OpeningBook.hpp"
+#include "Exception.hpp"
+#include "util/define_logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+DEFINE_LOGGER(OpeningBook)
+
+namespace {
+constexpr std::array<char, 8> bookMagic{'O', 'T', 'H', 'B', 'O', 'O', 'K', 0};
+
+constexpr std::uint32_t bookVersion = 1;
+
+/**
+ * Past this many interpolations the records left are not spread evenly
+ * enough for another one to help
+ */
+constexpr int maxInterpolations = 4;
+
+/** Ranges this small are bisected right away */
+constexpr std::size_t bisectionRecords = 64;
+
+std::string errorText(const std::string &what,
+                      const std::filesystem::path &path) {
+  return what + " " + path.string() + ": " + std::strerror(errno);
+}
+} // namespace
+
+OpeningBook::OpeningBook(const std::filesystem::path &path) {
+  const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file < 0)
+    THROW_SIMPLE_EXCEPTION(errorText("Cannot open the opening book", path));
+  struct stat status {};
+  if (::fstat(file, &status) != 0) {
+    const std::string message = errorText("Cannot read", path);
+    ::close(file);
+    THROW_SIMPLE_EXCEPTION(message);
+  }
+  mappingSize = static_cast<std::size_t>(status.st_size);
+  if (mappingSize < sizeof(Header)) {
+    ::close(file);
+    THROW_SIMPLE_EXCEPTION(path.string() + " is no opening book");
+  }
+  mapping = ::mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, file, 0);
+  // the mapping keeps the file open
+  ::close(file);
+  if (mapping == MAP_FAILED)
+    THROW_SIMPLE_EXCEPTION(errorText("Cannot map", path));
+
+  const auto *const header = static_cast<const Header *>(mapping);
+  if (header->magic != bookMagic || header->version != bookVersion ||
+      header->recordSize != sizeof(Record) ||
+      mappingSize !=
+          sizeof(Header) + header->recordCount * sizeof(Record)) {
+    ::munmap(mapping, mappingSize);
+    THROW_SIMPLE_EXCEPTION(path.string() +
+                           " is no opening book this version can read");
+  }
+  // lookups jump around, reading ahead would only waste the page cache
+  ::madvise(mapping, mappingSize, MADV_RANDOM);
+  records = {reinterpret_cast<const Record *>(header + 1),
+             header->recordCount};
+  LOG4CPLUS_INFO(GetLogger(), "Opened the opening book "
+                                  << path << " with " << records.size()
+                                  << " moves");
+}
+
+OpeningBook::~OpeningBook() { ::munmap(mapping, mappingSize); }
+
+std::vector<MoveScore> OpeningBook::moves(const Othello &othello) const {
+  const Othello::Canonical canonical = othello.canonical();
+  const symmetry::Symmetry back = symmetry::inverse(canonical.symmetry);
+  std::vector<MoveScore> moves;
+  // the records of a position are sorted best first
+  for (const Record &record : find(canonical.position.hash())) {
+    const int square = symmetry::transformSquare(record.square, back);
+    moves.push_back({.principalVariation = {
+                         .moves = {{square % Othello::boardSize,
+                                    square / Othello::boardSize}},
+                         .score = record.score}});
+  }
+  return moves;
+}
+
+OpeningBook::Record OpeningBook::record(const Othello &othello, int square,
+                                        double score, std::uint32_t games) {
+  const Othello::Canonical canonical = othello.canonical();
+  return {.hash = canonical.position.hash(),
+          .score = score,
+          .games = games,
+          .square = symmetry::transformSquare(square, canonical.symmetry)};
+}
+
+void OpeningBook::write(const std::filesystem::path &path,
+                        std::vector<Record> records) {
+  std::ranges::sort(records, [](const Record &a, const Record &b) {
+    if (a.hash != b.hash)
+      return a.hash < b.hash;
+    if (a.score != b.score)
+      return a.score > b.score;
+    return a.games > b.games;
+  });
+  const Header header{.magic = bookMagic,
+                      .version = bookVersion,
+                      .recordSize = sizeof(Record),
+                      .recordCount = records.size()};
+  std::filesystem::path temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(records.data()),
+               static_cast<std::streamsize>(records.size() * sizeof(Record)));
+    file.flush();
+    if (!file)
+      THROW_SIMPLE_EXCEPTION(errorText("Cannot write", temporary));
+  }
+  std::filesystem::rename(temporary, path);
+}
+
+std::span<const OpeningBook::Record>
+OpeningBook::find(std::uint64_t hash) const {
+  // the records of the hash are somewhere in [low, high)
+  std::size_t low = 0;
+  std::size_t high = records.size();
+  for (int probe = 0;
+       probe < maxInterpolations && high - low > bisectionRecords; ++probe) {
+    const std::uint64_t first = records[low].hash;
+    const std::uint64_t last = records[high - 1].hash;
+    if (hash < first || hash > last)
+      return {};
+    if (first == last)
+      break;
+    const long double fraction = static_cast<long double>(hash - first) /
+                                 static_cast<long double>(last - first);
+    const std::size_t guess =
+        low + static_cast<std::size_t>(
+                  fraction * static_cast<long double>(high - 1 - low));
+    if (records[guess].hash < hash)
+      low = guess + 1;
+    else if (records[guess].hash > hash)
+      high = guess;
+    else
+      break;
+  }
+  const auto found = std::ranges::equal_range(
+      records.subspan(low, high - low), hash, {}, &Record::hash);
+  return {found.begin(), found.end()};
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "MoveScore.hpp"
+#include "Othello.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Moves worked out ahead of time for the positions every game goes through,
+ * read from a file that is mapped into memory rather than loaded. Lookups
+ * touch a handful of pages, and processes reading the same book share one
+ * copy of it in the page cache.
+ *
+ * The file is a header followed by fixed size records, one for every move
+ * of every position in the book, sorted by the hash of the position. Each
+ * position is stored once for all the positions symmetric to it, so the
+ * records hold the canonical position and the moves in its coordinates.
+ * Numbers are stored the way the machine that wrote the book stores them.
+ */
+class OpeningBook {
+public:
+  struct Record {
+    /** The Zobrist hash of the canonical position */
+    std::uint64_t hash;
+    /** What the move is worth to the side to move */
+    double score;
+    /** How many games or book lines went through the move */
+    std::uint32_t games;
+    /** The square of the move in the canonical position */
+    std::int32_t square;
+  };
+  static_assert(sizeof(Record) == 24 && std::is_trivially_copyable_v<Record>,
+                "Records are read straight from the file");
+
+  /**
+   * Maps the book into memory, read only
+   * @param path
+   */
+  explicit OpeningBook(const std::filesystem::path &path);
+
+  OpeningBook(const OpeningBook &) = delete;
+
+  OpeningBook &operator=(const OpeningBook &) = delete;
+
+  ~OpeningBook();
+
+  /**
+   * @param othello
+   * @return The book moves of the position in its own coordinates, best
+   * first, none when the book does not know the position. Their lines hold
+   * the move alone, at depth 0.
+   */
+  [[nodiscard]] std::vector<MoveScore> moves(const Othello &othello) const;
+
+  /**
+   * @return The number of records, a few for every position
+   */
+  [[nodiscard]] std::size_t size() const { return records.size(); }
+
+  /**
+   * @param othello
+   * @param square The square of a move in the position
+   * @param score
+   * @param games
+   * @return The record of the move, in the coordinates of the canonical
+   * position
+   */
+  static Record record(const Othello &othello, int square, double score,
+                       std::uint32_t games);
+
+  /**
+   * Writes a book next to the path and moves it there once it is complete,
+   * so readers never see half a book
+   * @param path
+   * @param records In any order
+   */
+  static void write(const std::filesystem::path &path,
+                    std::vector<Record> records);
+
+private:
+  struct Header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    /** Catches books written with another record layout or byte order */
+    std::uint32_t recordSize;
+    std::uint64_t recordCount;
+  };
+
+  /**
+   * Interpolates where the hash should be, which takes a couple of probes
+   * because Zobrist hashes spread evenly, then bisects what is left
+   * @param hash
+   * @return The records of the position
+   */
+  [[nodiscard]] std::span<const Record> find(std::uint64_t hash) const;
+
+  void *mapping = nullptr;
+  std::size_t mappingSize = 0;
+  std::span<const Record> records;
+};
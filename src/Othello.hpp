@@ -1,62 +1,266 @@
 #pragma once
 
+#include "LegalMoves.hpp"
+#include "OthelloFwd.hpp"
+#include "bitboard.hpp"
+#include "symmetry.hpp"
+#include "zobrist.hpp"
 #include <array>
-#include <unordered_map>
+#include <cstddef>
+#include <functional>
 #include <utility>
-#include <vector>
 
-struct HashPair {
-  template <class T1, class T2>
-  std::size_t operator()(const std::pair<T1, T2> &p) const {
-    auto hash1 = std::hash<T1>{}(p.first);
-    auto hash2 = std::hash<T2>{}(p.second);
-    return hash1 ^ hash2;
-  }
-};
-
-class Othello {
+/**
+ * The game engine, parameterized on the number of rows and columns.
+ *
+ * Use the Othello alias for the standard 8x8 game. The 6x6 and 10x10 boards
+ * are compiled into the library as well, see Othello.cpp.
+ * @tparam N The board size
+ */
+template <int N> class BasicOthello {
 public:
   enum class State { EMPTY, WHITE, BLACK };
-  static constexpr int boardSize = 8;
+  static constexpr int boardSize = N;
+  /** One bit per square, see BasicOthello::square for the layout */
+  using Bitboard = bitboard::BasicBitboard<N>;
   using BoardState = std::array<std::array<State, boardSize>, boardSize>;
-  using Captures = std::vector<std::pair<int, int>>;
-  using LegalMoves =
-      std::unordered_map<std::pair<int, int>, Captures, HashPair>;
+  using LegalMove = BasicLegalMove<N>;
+  using LegalMoves = BasicLegalMoves<N>;
+
+  /**
+   * Everything BasicOthello::undoMove needs to take a move back
+   */
+  struct UndoInfo {
+    LegalMove move;
+    zobrist::Key hash;
+  };
+
+  struct Canonical;
+
+  BasicOthello();
 
-  Othello();
+  /**
+   * Sets up an arbitrary position
+   * @param black The black discs
+   * @param white The white discs, must not overlap the black ones
+   * @param blackTurn
+   */
+  BasicOthello(Bitboard black, Bitboard white, bool blackTurn);
 
-  Othello(const Othello &) = default;
+  BasicOthello(const BasicOthello &) = default;
 
-  Othello(Othello &&) = default;
+  BasicOthello(BasicOthello &&) = default;
 
-  Othello &operator=(const Othello &) = default;
+  BasicOthello &operator=(const BasicOthello &) = default;
 
-  Othello &operator=(Othello &&) = default;
+  BasicOthello &operator=(BasicOthello &&) = default;
 
   /**
    * Gets the current score as a pair, black score first, white score second
    * @return
    */
-  [[nodiscard]] std::pair<int, int> score() const;
+  [[nodiscard]] std::pair<int, int> score() const {
+    return {blackCount(), whiteCount()};
+  }
+
+  [[nodiscard]] int blackCount() const { return bitboard::popcount(black); }
+
+  [[nodiscard]] int whiteCount() const { return bitboard::popcount(white); }
+
+  /**
+   * @return The number of discs of either color on the board
+   */
+  [[nodiscard]] int discCount() const {
+    return bitboard::popcount(black | white);
+  }
+
+  [[nodiscard]] int emptyCount() const { return N * N - discCount(); }
 
-  [[nodiscard]] Captures captured(int x, int y, bool isBlack) const;
+  /**
+   * @return The discs that would flip if the given player moved on the square
+   */
+  [[nodiscard]] Bitboard captured(int x, int y, bool isBlack) const;
 
+  /**
+   * Plays a move for the side to move after checking that it is legal, then
+   * passes for the opponent if they are left without a move
+   * @param x
+   * @param y
+   */
   void placePiece(int x, int y);
 
-  [[nodiscard]] const BoardState &boardState() const { return boardState_; }
+  /**
+   * Plays a move for the side to move without any validation, meant for
+   * searches that got the move from BasicOthello::legalMoves.
+   *
+   * Unlike BasicOthello::placePiece it never passes on its own, the caller
+   * checks BasicOthello::legalMoveMask and calls BasicOthello::doPass when
+   * needed.
+   * @param move A legal move in this position
+   * @return What BasicOthello::undoMove needs to restore this position
+   */
+  UndoInfo doMove(const LegalMove &move) {
+    const UndoInfo undoInfo{move, hash_};
+    Bitboard &own = blackTurn ? black : white;
+    Bitboard &opponent = blackTurn ? white : black;
+    own |= move.flips | Bitboard{1} << move.square;
+    opponent &= ~move.flips;
+    hash_ ^= zobrist::disc<N>(move.square, blackTurn) ^ zobrist::whiteTurn<N>();
+    for (Bitboard flips = move.flips; flips;)
+      hash_ ^= zobrist::flip<N>(bitboard::popSquare(flips));
+    blackTurn = !blackTurn;
+    return undoInfo;
+  }
+
+  /**
+   * Takes back the last move made with BasicOthello::doMove
+   * @param undoInfo The value returned by that call
+   */
+  void undoMove(const UndoInfo &undoInfo) {
+    blackTurn = !blackTurn;
+    Bitboard &own = blackTurn ? black : white;
+    Bitboard &opponent = blackTurn ? white : black;
+    own &= ~(undoInfo.move.flips | Bitboard{1} << undoInfo.move.square);
+    opponent |= undoInfo.move.flips;
+    hash_ = undoInfo.hash;
+  }
+
+  /**
+   * Hands the turn to the opponent, it is its own inverse
+   */
+  void doPass() {
+    blackTurn = !blackTurn;
+    hash_ ^= zobrist::whiteTurn<N>();
+  }
+
+  /**
+   * The Zobrist hash of the position, covering the discs and the side to
+   * move. Kept up to date by every move, so reading it is free.
+   * @return
+   */
+  [[nodiscard]] zobrist::Key hash() const { return hash_; }
+
+  /**
+   * @return This position with the symmetry applied to every disc
+   */
+  [[nodiscard]] BasicOthello transformed(symmetry::Symmetry symmetry) const;
+
+  /**
+   * Picks one representative out of the (up to) eight positions that are
+   * symmetric to this one, so that caches and books can store each position
+   * once. A move in this position maps to the canonical one with
+   * symmetry::transformSquare(square, canonical.symmetry), and back with the
+   * symmetry::inverse of it.
+   * @return The canonical position and the symmetry that produces it
+   */
+  [[nodiscard]] Canonical canonical() const;
+
+  /**
+   * Drops legal moves that lead to the same position as another legal move up
+   * to symmetry, e.g. three of the four opening moves
+   * @return Legal moves with one representative per group of equivalent moves
+   */
+  [[nodiscard]] Bitboard distinctMoveMask() const;
+
+  /**
+   * Builds a grid view of the board, indexed by [x][y]. This is meant for the
+   * GUI and for diagnostics, use BasicOthello::at or the bitboards anywhere
+   * speed matters.
+   * @return
+   */
+  [[nodiscard]] BoardState boardState() const;
+
+  [[nodiscard]] State at(int x, int y) const {
+    const Bitboard mask = bit(x, y);
+    if (black & mask)
+      return State::BLACK;
+    if (white & mask)
+      return State::WHITE;
+    return State::EMPTY;
+  }
+
+  [[nodiscard]] Bitboard blackDiscs() const { return black; }
+
+  [[nodiscard]] Bitboard whiteDiscs() const { return white; }
+
+  /**
+   * Squares are numbered row by row, so x is the column and y is the row
+   * @param x
+   * @param y
+   * @return The index of the bit representing the square in a Bitboard
+   */
+  static constexpr int square(int x, int y) {
+    return bitboard::square<N>(x, y);
+  }
+
+  static constexpr Bitboard bit(int x, int y) {
+    return Bitboard{1} << square(x, y);
+  }
 
   [[nodiscard]] bool isBlackTurn() const { return blackTurn; }
 
-  [[nodiscard]] const LegalMoves &legalMoves() const { return legalMoves_; }
+  /**
+   * Generates the legal moves for the side to move. Nothing is cached, so
+   * keep the result around rather than calling this repeatedly.
+   * @return
+   */
+  [[nodiscard]] LegalMoves legalMoves() const {
+    return blackTurn ? LegalMoves{black, white} : LegalMoves{white, black};
+  }
 
-private:
-  void calculateLegalMoves();
+  /**
+   * Generates the legal moves for the side to move into a list that already
+   * exists, such as one in a preallocated search frame
+   * @param legalMoves
+   */
+  void legalMoves(LegalMoves &legalMoves) const {
+    if (blackTurn)
+      legalMoves.generate(black, white);
+    else
+      legalMoves.generate(white, black);
+  }
 
-  LegalMoves legalMoves_;
-  BoardState boardState_;
+  /**
+   * @return A bitboard of every square the side to move can play on
+   */
+  [[nodiscard]] Bitboard legalMoveMask() const {
+    return blackTurn ? bitboard::legalMoves<N>(black, white)
+                     : bitboard::legalMoves<N>(white, black);
+  }
+
+private:
+  Bitboard black = 0;
+  Bitboard white = 0;
+  zobrist::Key hash_ = 0;
   bool blackTurn = true;
 };
 
-bool operator==(const Othello &a, const Othello &b);
+template <int N> struct BasicOthello<N>::Canonical {
+  BasicOthello position;
+  symmetry::Symmetry symmetry;
+};
+
+/**
+ * Positions are equal when they have the same discs and the same side to move
+ */
+template <int N>
+bool operator==(const BasicOthello<N> &a, const BasicOthello<N> &b) {
+  return a.blackDiscs() == b.blackDiscs() &&
+         a.whiteDiscs() == b.whiteDiscs() &&
+         a.isBlackTurn() == b.isBlackTurn();
+}
+
+template <int N>
+bool operator!=(const BasicOthello<N> &a, const BasicOthello<N> &b) {
+  return !(a == b);
+}
+
+template <int N> struct std::hash<BasicOthello<N>> {
+  std::size_t operator()(const BasicOthello<N> &othello) const noexcept {
+    return othello.hash();
+  }
+};
 
-inline bool operator!=(const Othello &a, const Othello &b) { return !(a == b); }
+extern template class BasicOthello<6>;
+extern template class BasicOthello<8>;
+extern template class BasicOthello<10>;
@@ -0,0 +1,10 @@
+#pragma once
+
+template <int N> class BasicOthello;
+template <int N> struct BasicLegalMove;
+template <int N> class BasicLegalMoves;
+
+/** The standard 8x8 game, which is what the AIs and the GUI play */
+using Othello = BasicOthello<8>;
+using LegalMove = BasicLegalMove<8>;
+using LegalMoves = BasicLegalMoves<8>;
@@ -1,6 +1,8 @@
 #include "OthelloWindow.hpp"
 #include "util/define_logger.hpp"
 #include <boost/exception/diagnostic_information.hpp>
+#include <iomanip>
+#include <sstream>
 
 DEFINE_LOGGER(OthelloWindow)
 
@@ -37,11 +39,15 @@ void OthelloWindow::operator()() {
       renderPieces();
       if (errorInfo)
         return;
-      if (othello().legalMoves().empty())
+      if (!othello().legalMoveMask())
         return;
-      if (isPlayerTurn())
+      if (isPlayerTurn()) {
+        // the engine ponders once the analysis is done
+        startAnalysis();
+        startPondering();
+        renderAnalysis();
         handlePlayerTurn();
-      else
+      } else
         handleComputerTurn();
     });
   }
@@ -73,10 +79,10 @@ void OthelloWindow::renderPieces() {
   float yOffset = windowSize.y / (Othello::boardSize * 2);
   float xSize = windowSize.x / Othello::boardSize;
   float ySize = windowSize.y / Othello::boardSize;
-  for (int i = 0; i < othello_.boardState().size(); ++i) {
-    for (int j = 0; j < othello_.boardState().size(); ++j) {
+  for (int i = 0; i < Othello::boardSize; ++i) {
+    for (int j = 0; j < Othello::boardSize; ++j) {
       ImColor color{};
-      switch (othello_.boardState()[i][j]) {
+      switch (othello_.at(i, j)) {
       case Othello::State::EMPTY:
         continue;
       case Othello::State::WHITE:
@@ -94,14 +100,15 @@ void OthelloWindow::renderPieces() {
 }
 
 void OthelloWindow::drawGhosts(int x, int y) {
-  const auto iter = othello().legalMoves().find({x, y});
-  if (iter == othello().legalMoves().end()) {
+  const Othello::LegalMoves legalMoves = othello().legalMoves();
+  const auto iter = legalMoves.find(x, y);
+  if (iter == legalMoves.end()) {
     using namespace exception;
     THROW_EXCEPTION((Exception{}
                      << Because{"Cannot draw ghosts for illegal move"}
                      << Move{{x, y}} << Board{othello().boardState()}));
   }
-  const auto &captures = othello().legalMoves().find({x, y})->second;
+  Othello::Bitboard captures = iter->flips;
   auto windowSize = ImGui::GetWindowSize();
   auto drawList = ImGui::GetWindowDrawList();
   auto pos = ImGui::GetWindowPos();
@@ -113,7 +120,10 @@ void OthelloWindow::drawGhosts(int x, int y) {
       {pos.x + xSize * (float)x + xOffset, pos.y + ySize * (float)y + yOffset},
       std::min(xSize / 3, ySize / 3),
       othello().isBlackTurn() ? blackGhostColor : whiteGhostColor, 24);
-  for (const auto [x, y] : captures) {
+  while (captures) {
+    const int capture = bitboard::popSquare(captures);
+    const int x = capture % Othello::boardSize;
+    const int y = capture / Othello::boardSize;
     drawList->AddCircleFilled(
         {pos.x + xSize * (float)x + xOffset,
          pos.y + ySize * (float)y + yOffset},
@@ -123,6 +133,12 @@ void OthelloWindow::drawGhosts(int x, int y) {
 }
 
 void OthelloWindow::reset(std::unique_ptr<AI> ai) {
+  stopAnalysis();
+  stopPondering();
+  // the search finishes in the background once it notices
+  computerSearch.stop();
+  computerSearch = {};
+  computerMove = std::nullopt;
   othello_ = {};
   this->ai = std::move(ai);
   errorInfo = std::nullopt;
@@ -149,51 +165,153 @@ void OthelloWindow::handlePlayerTurn() {
     if (x >= Othello::boardSize || y >= Othello::boardSize)
       return;
 
-    if (othello_.boardState()[x][y] != Othello::State::EMPTY)
+    if (!othello().legalMoves().contains(x, y))
       return;
 
-    const auto iter = othello().legalMoves().find({x, y});
-    if (iter == othello().legalMoves().end())
-      return;
-    const auto &captures = iter->second;
-
     drawGhosts(x, y);
 
     if (ImGui::IsMouseClicked(0)) {
+      stopAnalysis();
+      stopPondering();
       placePiece(x, y);
     }
   }
 }
 
 void OthelloWindow::handleComputerTurn() {
-  if (!computerMoveFuture.has_value()) {
-    computerMoveFuture =
-        std::async(std::launch::async, [this] { return ai->go(othello()); });
+  if (!computerSearch.valid()) {
+    computerSearch = engine.start(ai, othello());
     return;
   }
-  if (!computerMove.has_value() && computerMoveFuture->valid() &&
-      computerMoveFuture->wait_for(std::chrono::duration<int>::zero()) ==
-          std::future_status::ready) {
+  if (!computerMove.has_value() && computerSearch.done()) {
     try {
-      computerMove = computerMoveFuture->get();
+      computerMove = computerSearch.poll();
       computerMoveTime = Clock::now();
     } catch (...) {
       errorInfo = boost::current_exception_diagnostic_information(true);
     }
   }
 
-  if (!computerMove.has_value())
+  if (!computerMove.has_value()) {
+    renderProgress();
     return;
+  }
 
   if (Clock::now() - computerMoveTime < std::chrono::seconds{1})
     drawGhosts(computerMove->first, computerMove->second);
   else {
     placePiece(computerMove->first, computerMove->second);
-    computerMoveFuture = std::nullopt;
+    computerSearch = {};
     computerMove = std::nullopt;
   }
 }
 
 void OthelloWindow::placePiece(int x, int y) { othello_.placePiece(x, y); }
 
-bool OthelloWindow::gameOver() const { return othello().legalMoves().empty(); }
+void OthelloWindow::setPondering(bool pondering) {
+  if (!pondering)
+    stopPondering();
+  pondering_ = pondering;
+}
+
+void OthelloWindow::startPondering() {
+  if (!pondering_ || !ai || ponderSearch.valid())
+    return;
+  ponderSearch = engine.ponder(ai, othello());
+}
+
+void OthelloWindow::stopPondering() {
+  ponderSearch.stop();
+  if (ponderSearch.done()) {
+    try {
+      // pondering only ever hands back errors
+      (void)ponderSearch.poll();
+    } catch (...) {
+      LOG4CPLUS_WARN(GetLogger(),
+                     "Pondering failed: "
+                         << boost::current_exception_diagnostic_information());
+    }
+  }
+  ponderSearch = {};
+}
+
+void OthelloWindow::setAnalyzing(bool analyzing) {
+  if (analyzing)
+    // pondering only ends with the turn, the analysis would never start
+    stopPondering();
+  else
+    stopAnalysis();
+  analyzing_ = analyzing;
+}
+
+void OthelloWindow::startAnalysis() {
+  if (!analyzing_ || !ai || analysisSearch.valid())
+    return;
+  analysisSearch = engine.analyze(ai, othello());
+}
+
+void OthelloWindow::stopAnalysis() {
+  analysisSearch.stop();
+  analysisSearch = {};
+  moveScores = std::nullopt;
+}
+
+void OthelloWindow::renderAnalysis() {
+  if (!moveScores && analysisSearch.done()) {
+    try {
+      moveScores = analysisSearch.analysis();
+    } catch (...) {
+      errorInfo = boost::current_exception_diagnostic_information(true);
+      return;
+    }
+  }
+  std::vector<MoveScore> scores;
+  if (moveScores)
+    scores = *moveScores;
+  else if (std::optional progress = analysisSearch.progress())
+    scores = std::move(progress->moveScores);
+  if (scores.empty())
+    return;
+
+  // best first, so the exact scores span from the front to the last one
+  const double best = scores.front().principalVariation.score;
+  double worst = best;
+  for (const MoveScore &score : scores)
+    if (score.bound == MoveScore::Bound::EXACT)
+      worst = std::min(worst, score.principalVariation.score);
+  auto windowSize = ImGui::GetWindowSize();
+  auto drawList = ImGui::GetWindowDrawList();
+  auto pos = ImGui::GetWindowPos();
+  float xSize = windowSize.x / Othello::boardSize;
+  float ySize = windowSize.y / Othello::boardSize;
+  for (const MoveScore &score : scores) {
+    const auto [x, y] = score.move();
+    const bool exact = score.bound == MoveScore::Bound::EXACT;
+    const float share =
+        exact && best > worst ? static_cast<float>(
+                                    (score.principalVariation.score - worst) /
+                                    (best - worst))
+        : exact               ? 1
+                              : 0;
+    const ImVec2 min{pos.x + xSize * (float)x, pos.y + ySize * (float)y};
+    drawList->AddRectFilled(min, {min.x + xSize, min.y + ySize},
+                            ImColor{1 - share, share, 0.0f, 0.4f});
+    std::ostringstream text;
+    text << (exact ? "" : "<") << std::setprecision(3)
+         << score.principalVariation.score;
+    drawList->AddText({min.x + 4, min.y + 4}, whiteColor, text.str().c_str());
+  }
+}
+
+void OthelloWindow::renderProgress() const {
+  const std::optional progress = computerSearch.progress();
+  if (!progress)
+    return;
+  std::ostringstream text;
+  text << "Depth " << progress->principalVariation.depth << ", score "
+       << progress->principalVariation.score << ", " << progress->nodes
+       << " nodes: " << progress->principalVariation;
+  ImGui::TextUnformatted(text.str().c_str());
+}
+
+bool OthelloWindow::gameOver() const { return !othello().legalMoveMask(); }
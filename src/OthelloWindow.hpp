@@ -1,12 +1,14 @@
 #pragma once
 
 #include "AI.hpp"
+#include "MoveScore.hpp"
 #include "Othello.hpp"
+#include "SearchEngine.hpp"
 #include "gui/ImGuiWrapper.hpp"
 #include <chrono>
-#include <future>
 #include <memory>
 #include <optional>
+#include <vector>
 
 class OthelloWindow {
 public:
@@ -22,6 +24,22 @@ public:
 
   bool gameOver() const;
 
+  [[nodiscard]] bool pondering() const { return pondering_; }
+
+  /**
+   * @param pondering Whether the AI keeps thinking on the player's turn,
+   * which makes it answer the player's move sooner
+   */
+  void setPondering(bool pondering);
+
+  [[nodiscard]] bool analyzing() const { return analyzing_; }
+
+  /**
+   * @param analyzing Whether the AI scores every move on the player's turn,
+   * which are shown on the board
+   */
+  void setAnalyzing(bool analyzing);
+
 private:
   static void renderGrid();
 
@@ -37,17 +55,59 @@ private:
 
   void placePiece(int x, int y);
 
+  /**
+   * Lets the AI think about the position on the player's turn, unless it
+   * already does
+   */
+  void startPondering();
+
+  /**
+   * Tells the AI to stop thinking on the player's turn, without waiting
+   */
+  void stopPondering();
+
+  /**
+   * Lets the AI score the moves of the position on the player's turn,
+   * unless it already does
+   */
+  void startAnalysis();
+
+  /**
+   * Tells the AI to stop scoring moves and forgets the scores
+   */
+  void stopAnalysis();
+
+  /**
+   * Shades the legal squares from red for the worst move to green for the
+   * best and writes the score of each move on it, moves that were only
+   * bounded stay red
+   */
+  void renderAnalysis();
+
+  /**
+   * Shows what the AI is thinking about its move
+   */
+  void renderProgress() const;
+
   using Clock = std::chrono::steady_clock;
   using TimePoint = std::chrono::time_point<Clock>;
 
   Othello othello_;
   TimePoint computerMoveTime;
-  std::optional<std::future<AI::Move>> computerMoveFuture{};
+  SearchEngine engine;
+  SearchEngine::Handle computerSearch;
   std::optional<AI::Move> computerMove;
   gui::WindowConfig config;
   gui::WindowConfig errorWindowConfig;
-  std::unique_ptr<AI> ai;
+  /** Shared with the searches, which may outlive it after a reset */
+  std::shared_ptr<AI> ai;
   bool aiIsBlack = true;
   std::optional<std::string> errorInfo{};
   gui::ImGuiWrapper &imGuiWrapper;
+  bool pondering_ = false;
+  SearchEngine::Handle ponderSearch;
+  bool analyzing_ = false;
+  SearchEngine::Handle analysisSearch;
+  /** The scores of the finished analysis */
+  std::optional<std::vector<MoveScore>> moveScores;
 };
@@ -0,0 +1,16 @@
+#include "PrincipalVariation.hpp"
+#include <ostream>
+
+std::ostream &operator<<(std::ostream &stream,
+                         const PrincipalVariation &principalVariation) {
+  const char *separator = "";
+  for (const auto &[x, y] : principalVariation.moves) {
+    stream << separator;
+    if (x < 0)
+      stream << "pass";
+    else
+      stream << static_cast<char>('a' + x) << y + 1;
+    separator = " ";
+  }
+  return stream;
+}
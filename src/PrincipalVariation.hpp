@@ -0,0 +1,24 @@
+#pragma once
+
+#include "AI.hpp"
+#include <iosfwd>
+#include <vector>
+
+/**
+ * The line of play a search expects from a position: its best move, the best
+ * reply to that, and so on for as far as the search can vouch for it
+ */
+struct PrincipalVariation {
+  /** The moves in the order they are played, {-1, -1} for a pass */
+  std::vector<AI::Move> moves;
+  /** What the line is worth to the side to move at its start */
+  double score = 0;
+  /** The depth of the search that found the line */
+  int depth = 0;
+};
+
+/**
+ * Writes the moves in board notation, such as "f5 d6 pass c3"
+ */
+std::ostream &operator<<(std::ostream &stream,
+                         const PrincipalVariation &principalVariation);
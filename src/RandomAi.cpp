@@ -4,13 +4,9 @@
 
 AI::Move RandomAI::go(const Othello &othello) {
   static std::mt19937 generator{std::random_device{}()};
-  std::uniform_int_distribution distribution{0, Othello::boardSize - 1};
+  const Othello::LegalMoves legalMoves = othello.legalMoves();
+  std::uniform_int_distribution distribution{0, legalMoves.size() - 1};
 
-  Move move{-1, -1};
-  while (othello.legalMoves().find(move) == othello.legalMoves().end()) {
-    move.first = distribution(generator);
-    move.second = distribution(generator);
-  }
-
-  return move;
+  const LegalMove &move = legalMoves[distribution(generator)];
+  return {move.x(), move.y()};
 }
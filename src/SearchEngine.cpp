@@ -0,0 +1,171 @@
+#include "SearchEngine.hpp"
+#include "Othello.hpp"
+#include <atomic>
+#include <exception>
+#include <stop_token>
+#include <utility>
+
+struct SearchEngine::Job {
+  enum class Kind { GO, PONDER, ANALYZE };
+
+  Job(std::shared_ptr<AI> ai, const Othello &position, SearchLimits limits,
+      Kind kind, double margin = 0)
+      : ai{std::move(ai)}, position{position}, limits{std::move(limits)},
+        kind{kind}, margin{margin} {}
+
+  /** Let go of once the search ends */
+  std::shared_ptr<AI> ai;
+  const Othello position;
+  const SearchLimits limits;
+  const Kind kind;
+  const double margin;
+  std::stop_source stopSource;
+  std::atomic_bool done = false;
+  /** Guards what the search hands back */
+  std::mutex mutex;
+  std::optional<SearchProgress> progress;
+  std::optional<AI::Move> move;
+  std::optional<std::vector<MoveScore>> moveScores;
+  std::exception_ptr error;
+};
+
+void SearchEngine::Handle::stop() {
+  if (job)
+    job->stopSource.request_stop();
+}
+
+bool SearchEngine::Handle::done() const {
+  return job && job->done.load(std::memory_order_acquire);
+}
+
+std::optional<AI::Move> SearchEngine::Handle::poll() const {
+  if (!done())
+    return std::nullopt;
+  const std::lock_guard lock{job->mutex};
+  if (job->error)
+    std::rethrow_exception(job->error);
+  return job->move;
+}
+
+std::optional<std::vector<MoveScore>> SearchEngine::Handle::analysis() const {
+  if (!done())
+    return std::nullopt;
+  const std::lock_guard lock{job->mutex};
+  if (job->error)
+    std::rethrow_exception(job->error);
+  return job->moveScores;
+}
+
+std::optional<SearchProgress> SearchEngine::Handle::progress() const {
+  if (!job)
+    return std::nullopt;
+  const std::lock_guard lock{job->mutex};
+  return job->progress;
+}
+
+SearchEngine::SearchEngine()
+    : worker{[this](std::stop_token stopToken) {
+        while (true) {
+          std::shared_ptr<Job> job;
+          {
+            std::unique_lock lock{mutex};
+            if (!wakeUp.wait(lock, stopToken, [this] { return !jobs.empty(); }))
+              return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            running = job;
+          }
+          run(*job);
+          const std::lock_guard lock{mutex};
+          running.reset();
+        }
+      }} {}
+
+SearchEngine::~SearchEngine() {
+  {
+    const std::lock_guard lock{mutex};
+    for (const std::shared_ptr<Job> &job : jobs)
+      job->stopSource.request_stop();
+    if (running)
+      running->stopSource.request_stop();
+  }
+  worker.request_stop();
+}
+
+SearchEngine::Handle SearchEngine::start(std::shared_ptr<AI> ai,
+                                         const Othello &position,
+                                         SearchLimits limits) {
+  return queue(std::make_shared<Job>(std::move(ai), position,
+                                     std::move(limits), Job::Kind::GO));
+}
+
+SearchEngine::Handle SearchEngine::ponder(std::shared_ptr<AI> ai,
+                                          const Othello &position) {
+  return queue(std::make_shared<Job>(std::move(ai), position,
+                                     SearchLimits{}, Job::Kind::PONDER));
+}
+
+SearchEngine::Handle SearchEngine::analyze(std::shared_ptr<AI> ai,
+                                           const Othello &position,
+                                           SearchLimits limits,
+                                           double margin) {
+  return queue(std::make_shared<Job>(std::move(ai), position,
+                                     std::move(limits), Job::Kind::ANALYZE,
+                                     margin));
+}
+
+SearchEngine::Handle SearchEngine::queue(std::shared_ptr<Job> job) {
+  Handle handle{job};
+  {
+    const std::lock_guard lock{mutex};
+    jobs.push_back(std::move(job));
+  }
+  wakeUp.notify_one();
+  return handle;
+}
+
+void SearchEngine::run(Job &job) {
+  const std::stop_token stopToken = job.stopSource.get_token();
+  if (!stopToken.stop_requested()) {
+    // a stop token of the caller stops the search as well
+    const std::stop_callback forwardStop{
+        job.limits.stopToken, [&job] { job.stopSource.request_stop(); }};
+    SearchLimits limits = job.limits;
+    limits.stopToken = stopToken;
+    limits.onProgress = [&job](const SearchProgress &progress) {
+      {
+        const std::lock_guard lock{job.mutex};
+        job.progress = progress;
+      }
+      if (job.limits.onProgress)
+        job.limits.onProgress(progress);
+    };
+    try {
+      switch (job.kind) {
+      case Job::Kind::GO: {
+        const AI::Move move = job.ai->go(job.position, limits);
+        const std::lock_guard lock{job.mutex};
+        job.move = move;
+        break;
+      }
+      case Job::Kind::PONDER:
+        job.ai->ponder(job.position, stopToken);
+        break;
+      case Job::Kind::ANALYZE: {
+        std::vector<MoveScore> moveScores =
+            job.ai->analyze(job.position, limits, job.margin);
+        const std::lock_guard lock{job.mutex};
+        job.moveScores = std::move(moveScores);
+        break;
+      }
+      }
+    } catch (...) {
+      const std::lock_guard lock{job.mutex};
+      job.error = std::current_exception();
+    }
+  }
+  // the AI may be big, better to free it here than wherever the last
+  // handle goes
+  job.ai.reset();
+  job.done.store(true, std::memory_order_release);
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "AI.hpp"
+#include "MoveScore.hpp"
+#include "SearchLimits.hpp"
+#include "SearchProgress.hpp"
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs searches on a thread that lives as long as the engine, so that
+ * nobody has to wait for them and no thread is started for every move.
+ *
+ * Searches run one after the other in the order they were started. A
+ * search that is stopped ends as soon as it notices, and the AI it runs
+ * lives until then, even when everybody else has let go of it.
+ */
+class SearchEngine {
+  struct Job;
+
+public:
+  /**
+   * Follows a search started by the engine. A default constructed handle
+   * follows nothing.
+   */
+  class Handle {
+  public:
+    Handle() = default;
+
+    /**
+     * @return Whether the handle follows a search
+     */
+    [[nodiscard]] bool valid() const { return job != nullptr; }
+
+    /**
+     * Asks the search to stop, without waiting for it. A search that is
+     * still queued never starts.
+     */
+    void stop();
+
+    /**
+     * @return Whether the search ended, or never started after a stop
+     */
+    [[nodiscard]] bool done() const;
+
+    /**
+     * @return The move once the search is done, none before that, or if it
+     * was stopped before it started, or if it did not play. Rethrows what
+     * the search threw.
+     */
+    [[nodiscard]] std::optional<AI::Move> poll() const;
+
+    /**
+     * @return The scores of an analysis once it is done, none before that
+     * or if it was stopped before it started. Rethrows what the analysis
+     * threw.
+     */
+    [[nodiscard]] std::optional<std::vector<MoveScore>> analysis() const;
+
+    /**
+     * @return The latest progress the search reported, none before the
+     * first report
+     */
+    [[nodiscard]] std::optional<SearchProgress> progress() const;
+
+  private:
+    friend class SearchEngine;
+
+    explicit Handle(std::shared_ptr<Job> job) : job{std::move(job)} {}
+
+    std::shared_ptr<Job> job;
+  };
+
+  SearchEngine();
+
+  SearchEngine(const SearchEngine &) = delete;
+
+  SearchEngine &operator=(const SearchEngine &) = delete;
+
+  /**
+   * Stops every search and waits for the one that is running
+   */
+  ~SearchEngine();
+
+  /**
+   * Queues AI::go
+   * @param ai
+   * @param position
+   * @param limits Apply on top of the limits of the AI. Progress is
+   * reported to the handle as well as to them.
+   * @return
+   */
+  Handle start(std::shared_ptr<AI> ai, const Othello &position,
+               SearchLimits limits = {});
+
+  /**
+   * Queues AI::ponder, which runs until the handle stops it
+   * @param ai
+   * @param position
+   * @return
+   */
+  Handle ponder(std::shared_ptr<AI> ai, const Othello &position);
+
+  /**
+   * Queues AI::analyze
+   * @param ai
+   * @param position
+   * @param limits Apply on top of the limits of the AI. The scores found so
+   * far are reported to the handle as well as to them.
+   * @param margin
+   * @return
+   */
+  Handle analyze(std::shared_ptr<AI> ai, const Othello &position,
+                 SearchLimits limits = {},
+                 double margin = std::numeric_limits<double>::infinity());
+
+private:
+  Handle queue(std::shared_ptr<Job> job);
+
+  static void run(Job &job);
+
+  std::mutex mutex;
+  std::condition_variable_any wakeUp;
+  std::deque<std::shared_ptr<Job>> jobs;
+  std::shared_ptr<Job> running;
+  std::jthread worker;
+};
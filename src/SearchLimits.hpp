@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stop_token>
+
+struct SearchProgress;
+
+/**
+ * Bounds a search by depth, by the number of positions it visits, by wall
+ * clock time and by a stop request. The search ends at whichever bound it
+ * reaches first and plays the best move it has found by then.
+ */
+struct SearchLimits {
+  using Clock = std::chrono::steady_clock;
+
+  /** The number of plies of the deepest iteration */
+  int maxDepth = std::numeric_limits<int>::max();
+  /**
+   * The positions of the whole search, over all its threads. Parallel
+   * searches notice late and may go over by a thousand or so per thread.
+   */
+  std::uint64_t maxNodes = std::numeric_limits<std::uint64_t>::max();
+  std::optional<Clock::time_point> deadline{};
+  /** Lets another thread end the search, say once its result is moot */
+  std::stop_token stopToken{};
+  /**
+   * Not a limit but travels with them to every search, which calls it on
+   * its own thread with what it found so far
+   */
+  std::function<void(const SearchProgress &)> onProgress{};
+
+  static SearchLimits depth(int maxDepth) { return {.maxDepth = maxDepth}; }
+
+  /**
+   * @param budget How long the search may take from now on
+   * @return
+   */
+  static SearchLimits time(Clock::duration budget) {
+    return {.deadline = Clock::now() + budget};
+  }
+};
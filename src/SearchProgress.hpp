@@ -0,0 +1,24 @@
+#pragma once
+
+#include "MoveScore.hpp"
+#include "PrincipalVariation.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * What a running search has found so far, reported whenever it learns
+ * something new, such as at the end of every iteration
+ */
+struct SearchProgress {
+  /**
+   * The line the search expects. Its score is in the units of whatever
+   * searched it: heuristic points for MinMaxStrategy, with finished and
+   * solved games scored by gameOverScore on the same scale, and the share
+   * of playouts won for MctsStrategy.
+   */
+  PrincipalVariation principalVariation;
+  /** The positions or playouts the search went through so far */
+  std::uint64_t nodes = 0;
+  /** What an analysis found out about every legal move so far, best first */
+  std::vector<MoveScore> moveScores{};
+};
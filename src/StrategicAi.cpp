@@ -1,17 +1,129 @@
 #include "StrategicAi.hpp"
 #include "Exception.hpp"
 #include "Othello.hpp"
+#include "SearchProgress.hpp"
+#include "gameOverScore.hpp"
 #include "util/define_logger.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 
 DEFINE_LOGGER(StrategicAi)
 
-AI::Move StrategicAi::go(const Othello &othello) {
-  switch (othello.legalMoves().size()) {
+AI::Move StrategicAi::go(const Othello &othello) { return go(othello, {}); }
+
+AI::Move StrategicAi::go(const Othello &othello, const SearchLimits &limits) {
+  const Othello::LegalMoves legalMoves = othello.legalMoves();
+  switch (legalMoves.size()) {
   case 0:
     THROW_SIMPLE_EXCEPTION("No legal moves available");
   case 1:
-    return othello.legalMoves().begin()->first;
-  default:
-    return strategy->nextMove(heuristic, othello);
+    return {legalMoves[0].x(), legalMoves[0].y()};
+  default: {
+    if (book)
+      for (const MoveScore &bookMove : book->moves(othello)) {
+        const auto [x, y] = bookMove.move();
+        // guards against another position with the same hash
+        if (legalMoves.contains(x, y)) {
+          LOG4CPLUS_DEBUG(GetLogger(), "Book move scored "
+                                           << bookMove.principalVariation
+                                                  .score);
+          return bookMove.move();
+        }
+      }
+    const SearchLimits::Clock::time_point start = SearchLimits::Clock::now();
+    const SearchLimits searchLimits = withMoveTime(limits, start);
+    if (othello.emptyCount() <= solverEmpties) {
+      if (const std::optional result =
+              solver.solve(othello, solverLimits(limits, start))) {
+        LOG4CPLUS_DEBUG(GetLogger(), "Solved to a score of "
+                                         << result->score << " in "
+                                         << solver.nodeCount() << " nodes");
+        const Move move{result->square % Othello::boardSize,
+                        result->square / Othello::boardSize};
+        if (limits.onProgress) {
+          const PrincipalVariation solution{
+              .moves = {move},
+              .score = gameOverScore(result->score),
+              .depth = othello.emptyCount()};
+          limits.onProgress({.principalVariation = solution,
+                             .nodes = solver.nodeCount()});
+        }
+        return move;
+      }
+    }
+    return strategy->nextMove(heuristic, othello, searchLimits);
+  }
+  }
+}
+
+std::vector<MoveScore> StrategicAi::analyze(const Othello &othello,
+                                            const SearchLimits &limits,
+                                            double margin) {
+  if (!othello.legalMoveMask())
+    return {};
+  const SearchLimits::Clock::time_point start = SearchLimits::Clock::now();
+  if (othello.emptyCount() <= solverEmpties) {
+    SearchLimits limitsOfSolver = solverLimits(limits, start);
+    const Othello::LegalMoves legalMoves = othello.legalMoves();
+    std::vector<MoveScore> scores;
+    std::uint64_t nodes = 0;
+    for (const LegalMove &legalMove : legalMoves) {
+      Othello position = othello;
+      position.doMove(legalMove);
+      const std::optional result = solver.solve(position, limitsOfSolver);
+      nodes += solver.nodeCount();
+      // the node limit is for all the moves together
+      limitsOfSolver.maxNodes -=
+          std::min(limitsOfSolver.maxNodes, solver.nodeCount());
+      if (!result)
+        break;
+      scores.push_back(
+          {.principalVariation = {.moves = {{legalMove.x(), legalMove.y()}},
+                                  .score = gameOverScore(-result->score),
+                                  .depth = othello.emptyCount()}});
+    }
+    if (static_cast<int>(scores.size()) == legalMoves.size()) {
+      std::ranges::stable_sort(scores, std::greater{},
+                               [](const MoveScore &score) {
+                                 return score.principalVariation.score;
+                               });
+      if (limits.onProgress)
+        limits.onProgress(
+            {.principalVariation = scores.front().principalVariation,
+             .nodes = nodes,
+             .moveScores = scores});
+      return scores;
+    }
   }
+  return strategy->analyze(heuristic, othello, withMoveTime(limits, start),
+                           margin);
+}
+
+SearchLimits
+StrategicAi::withMoveTime(const SearchLimits &limits,
+                          SearchLimits::Clock::time_point start) const {
+  SearchLimits searchLimits = limits;
+  if (moveTime)
+    searchLimits.deadline = std::min(
+        limits.deadline.value_or(start + *moveTime), start + *moveTime);
+  return searchLimits;
+}
+
+SearchLimits
+StrategicAi::solverLimits(const SearchLimits &limits,
+                          SearchLimits::Clock::time_point start) const {
+  SearchLimits searchLimits = withMoveTime(limits, start);
+  if (moveTime)
+    searchLimits.deadline =
+        std::min(*searchLimits.deadline, start + *moveTime / 2);
+  return searchLimits;
+}
+
+void StrategicAi::ponder(const Othello &othello, std::stop_token stopToken) {
+  // the opponent's move fills a square
+  if (othello.emptyCount() - 1 <= solverEmpties && solverEmpties > 0)
+    solver.solve(othello, {.stopToken = std::move(stopToken)});
+  else
+    strategy->ponder(heuristic, othello, std::move(stopToken));
 }
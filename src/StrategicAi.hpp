@@ -1,17 +1,96 @@
 #pragma once
 
 #include "AI.hpp"
+#include "EndgameSolver.hpp"
+#include "OpeningBook.hpp"
+#include "SearchLimits.hpp"
 #include "Strategy.hpp"
 #include <memory>
+#include <optional>
 
 class StrategicAi : public AI {
 public:
-  StrategicAi(std::unique_ptr<Strategy> strategy, HeuristicFunction heuristic)
-      : strategy{std::move(strategy)}, heuristic{heuristic} {}
+  /** Solving twenty empty squares takes about a second */
+  static constexpr int defaultSolverEmpties = 20;
+
+  /**
+   * @param strategy
+   * @param heuristic
+   * @param moveTime How long the strategy may think about each move, when
+   * empty it searches to its own depth
+   * @param solverEmpties Positions with this many empty squares or fewer are
+   * solved to the end of the game instead of being left to the strategy, 0
+   * leaves them all to the strategy. A timed AI gives the solver half its
+   * time, and the strategy the rest if the solver does not finish.
+   * @param solverMode
+   * @param book Where to look up a position before searching it, the best
+   * book move is played right away. Can be shared by any number of AIs.
+   */
+  StrategicAi(std::unique_ptr<Strategy> strategy, HeuristicFunction heuristic,
+              std::optional<SearchLimits::Clock::duration> moveTime = {},
+              int solverEmpties = defaultSolverEmpties,
+              EndgameSolver::Mode solverMode = EndgameSolver::Mode::EXACT,
+              std::shared_ptr<const OpeningBook> book = nullptr)
+      : strategy{std::move(strategy)}, heuristic{heuristic},
+        moveTime{moveTime}, solverEmpties{solverEmpties}, solver{solverMode},
+        book{std::move(book)} {}
 
   Move go(const Othello &othello) override;
 
+  /**
+   * @param othello
+   * @param limits Apply on top of the move time
+   * @return
+   */
+  Move go(const Othello &othello, const SearchLimits &limits) override;
+
+  /**
+   * Leaves pondering to the strategy, or to the solver when the position
+   * after the opponent's move is one to solve
+   * @param othello
+   * @param stopToken
+   */
+  void ponder(const Othello &othello, std::stop_token stopToken) override;
+
+  /**
+   * Solves every move when the position is one to solve, and leaves the
+   * analysis to the strategy when it is not or when the solver runs out of
+   * time. Solved moves are scored like the searches score finished games,
+   * by gameOverScore, and are all exact. In WIN_LOSS_DRAW mode the solver
+   * only knows the sign of the disc difference, so every win scores
+   * winScore + 1 and every loss its negation.
+   * @param othello
+   * @param limits Apply on top of the move time
+   * @param margin
+   * @return
+   */
+  std::vector<MoveScore> analyze(const Othello &othello,
+                                 const SearchLimits &limits,
+                                 double margin) override;
+
 private:
+  /**
+   * @param limits
+   * @param start
+   * @return The limits with the deadline of the move time, if it is sooner
+   */
+  [[nodiscard]] SearchLimits
+  withMoveTime(const SearchLimits &limits,
+               SearchLimits::Clock::time_point start) const;
+
+  /**
+   * @param limits
+   * @param start
+   * @return The limits of the solver, which gets half the move time
+   */
+  [[nodiscard]] SearchLimits
+  solverLimits(const SearchLimits &limits,
+               SearchLimits::Clock::time_point start) const;
+
   const std::unique_ptr<Strategy> strategy;
   const HeuristicFunction heuristic;
+  const std::optional<SearchLimits::Clock::duration> moveTime;
+  const int solverEmpties;
+  EndgameSolver solver;
+  const std::shared_ptr<const OpeningBook> book;
 };
@@ -2,11 +2,53 @@
 
 #include "AI.hpp"
 #include "HeuristicFunction.hpp"
+#include "MoveScore.hpp"
+#include "SearchLimits.hpp"
+#include <vector>
 
 class Strategy {
 public:
   virtual AI::Move nextMove(HeuristicFunction heuristic,
                             const Othello &othello) = 0;
 
+  /**
+   * Searches within the given limits. Strategies that cannot stop early
+   * ignore the limits and search as they would without them.
+   * @param heuristic
+   * @param othello
+   * @param limits
+   * @return
+   */
+  virtual AI::Move nextMove(HeuristicFunction heuristic,
+                            const Othello &othello,
+                            const SearchLimits &) {
+    return nextMove(heuristic, othello);
+  }
+
+  /**
+   * Searches the position the opponent is to move in until a stop is
+   * requested, keeping what it finds for the next nextMove. Strategies that
+   * keep nothing between searches return right away.
+   * @param heuristic
+   * @param othello
+   * @param stopToken
+   */
+  virtual void ponder(HeuristicFunction, const Othello &, std::stop_token) {}
+
+  /**
+   * Scores every legal move, see AI::analyze
+   * @param heuristic
+   * @param othello
+   * @param limits
+   * @param margin
+   * @return The moves best first, none from strategies that cannot score
+   * them
+   */
+  virtual std::vector<MoveScore> analyze(HeuristicFunction, const Othello &,
+                                         const SearchLimits &,
+                                         double) {
+    return {};
+  }
+
   virtual ~Strategy() = default;
 };
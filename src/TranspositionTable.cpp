@@ -0,0 +1,19 @@
+#include "TranspositionTable.hpp"
+#include <algorithm>
+#include <bit>
+
+TranspositionTable::TranspositionTable(std::size_t megabytes) {
+  const std::size_t wanted = (megabytes << 20) / sizeof(Bucket);
+  const std::size_t count = std::bit_floor(std::max<std::size_t>(wanted, 1));
+  buckets = std::make_unique<Bucket[]>(count);
+  mask = count - 1;
+}
+
+void TranspositionTable::clear() {
+  for (std::size_t i = 0; i <= mask; ++i)
+    for (Slot *slot : {&buckets[i].deep, &buckets[i].recent}) {
+      slot->keyXorData.store(0, std::memory_order_relaxed);
+      slot->data.store(0, std::memory_order_relaxed);
+    }
+  generation = 0;
+}
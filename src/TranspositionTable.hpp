@@ -0,0 +1,160 @@
+#pragma once
+
+#include "zobrist.hpp"
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+
+/**
+ * A fixed size cache of search results keyed by Zobrist hash, meant to be
+ * shared by every search that runs on the same game, including searches
+ * running in parallel.
+ *
+ * Each bucket holds two entries: one that only gives way to results from
+ * deeper (or newer) searches, and one that always takes the latest result.
+ * An entry is two 64-bit words, the packed result and the key XORed with
+ * it. Threads read and write the words without locking, so a reader can see
+ * halves written by different threads; the XOR no longer matches the key
+ * then and the entry is treated as a miss.
+ */
+class TranspositionTable {
+public:
+  /** How the stored score relates to the true score of the position */
+  enum class Bound : std::uint8_t {
+    /** The score is exact */
+    EXACT,
+    /** The search failed high, the true score is at least this */
+    LOWER,
+    /** The search failed low, the true score is at most this */
+    UPPER
+  };
+
+  struct Entry {
+    /**
+     * The score for the side to move, stored with float precision. Bounds
+     * are rounded away from the scores they rule out, so that they still
+     * hold.
+     */
+    double score;
+    /** The square of the best move, -1 when there was none */
+    int move;
+    /** The number of plies searched below the position */
+    int depth;
+    Bound bound;
+  };
+
+  /**
+   * @param megabytes The memory to use, rounded down to a power of two
+   * number of buckets
+   */
+  explicit TranspositionTable(std::size_t megabytes);
+
+  /**
+   * @return The entry stored for the position, if there is one
+   */
+  [[nodiscard]] std::optional<Entry> probe(zobrist::Key key) const {
+    const Bucket &bucket = bucketFor(key);
+    for (const Slot *slot : {&bucket.deep, &bucket.recent}) {
+      const std::uint64_t data = slot->data.load(std::memory_order_relaxed);
+      if ((slot->keyXorData.load(std::memory_order_relaxed) ^ data) == key)
+        return unpack(data);
+    }
+    return std::nullopt;
+  }
+
+  void store(zobrist::Key key, const Entry &entry) {
+    Bucket &bucket = bucketFor(key);
+    const std::uint64_t data = pack(entry);
+    const std::uint64_t deepData =
+        bucket.deep.data.load(std::memory_order_relaxed);
+    const bool sameKey =
+        (bucket.deep.keyXorData.load(std::memory_order_relaxed) ^ deepData) ==
+        key;
+    Slot &slot = sameKey || entry.depth >= depthOf(deepData) ||
+                         generationOf(deepData) != generation
+                     ? bucket.deep
+                     : bucket.recent;
+    slot.keyXorData.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+  }
+
+  /**
+   * Marks the entries stored so far as stale, so that deeper results from
+   * earlier searches stop holding on to their slots. Call it before each new
+   * search, not while one is running.
+   */
+  void newSearch() { ++generation; }
+
+  /**
+   * Drops every entry, not safe to call while a search is running
+   */
+  void clear();
+
+  [[nodiscard]] std::size_t bucketCount() const { return mask + 1; }
+
+private:
+  struct Slot {
+    std::atomic<std::uint64_t> keyXorData{0};
+    std::atomic<std::uint64_t> data{0};
+  };
+
+  struct alignas(32) Bucket {
+    Slot deep;
+    Slot recent;
+  };
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+  static_assert(sizeof(Slot) == 16);
+
+  // data layout: score as a float, move, depth, bound, generation
+  static constexpr int moveShift = 32;
+  static constexpr int depthShift = 40;
+  static constexpr int boundShift = 48;
+  static constexpr int generationShift = 56;
+
+  [[nodiscard]] std::uint64_t pack(const Entry &entry) const {
+    return std::bit_cast<std::uint32_t>(roundedScore(entry)) |
+           std::uint64_t{static_cast<std::uint8_t>(entry.move)} << moveShift |
+           std::uint64_t{static_cast<std::uint8_t>(entry.depth)} << depthShift |
+           std::uint64_t{static_cast<std::uint8_t>(entry.bound)} << boundShift |
+           std::uint64_t{generation} << generationShift;
+  }
+
+  static float roundedScore(const Entry &entry) {
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    const auto score = static_cast<float>(entry.score);
+    if (entry.bound == Bound::LOWER && score > entry.score)
+      return std::nextafter(score, -infinity);
+    if (entry.bound == Bound::UPPER && score < entry.score)
+      return std::nextafter(score, infinity);
+    return score;
+  }
+
+  static Entry unpack(std::uint64_t data) {
+    const auto move = static_cast<std::uint8_t>(data >> moveShift);
+    return {std::bit_cast<float>(static_cast<std::uint32_t>(data)),
+            move == 0xFF ? -1 : move, depthOf(data),
+            static_cast<Bound>(static_cast<std::uint8_t>(data >> boundShift))};
+  }
+
+  static int depthOf(std::uint64_t data) {
+    return static_cast<std::uint8_t>(data >> depthShift);
+  }
+
+  static std::uint8_t generationOf(std::uint64_t data) {
+    return static_cast<std::uint8_t>(data >> generationShift);
+  }
+
+  [[nodiscard]] Bucket &bucketFor(zobrist::Key key) const {
+    return buckets[key & mask];
+  }
+
+  std::unique_ptr<Bucket[]> buckets;
+  std::size_t mask;
+  std::uint8_t generation = 0;
+};
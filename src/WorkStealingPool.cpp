@@ -0,0 +1,84 @@
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+
+namespace {
+/** The pool the current thread works for and its queue in that pool */
+thread_local const WorkStealingPool *currentPool = nullptr;
+thread_local int currentQueue = 0;
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int threads) {
+  const int count = std::max(threads, 1);
+  for (int i = 0; i < count; ++i)
+    queues.push_back(std::make_unique<Queue>());
+  // the constructing thread takes queue 0, the workers the rest
+  for (int i = 1; i < count; ++i)
+    workers.emplace_back([this, i](std::stop_token stopToken) {
+      currentPool = this;
+      currentQueue = i;
+      while (!stopToken.stop_requested())
+        if (!runOne(i))
+          std::this_thread::yield();
+    });
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  for (std::jthread &worker : workers)
+    worker.request_stop();
+}
+
+void WorkStealingPool::submit(Group &group, Task task) {
+  group.pending.fetch_add(1, std::memory_order_relaxed);
+  Queue &queue = *queues[threadIndex()];
+  const std::lock_guard lock{queue.mutex};
+  queue.tasks.emplace_back(&group, std::move(task));
+}
+
+void WorkStealingPool::wait(Group &group) {
+  const int queue = threadIndex();
+  while (group.pending.load(std::memory_order_acquire) > 0)
+    if (!runOne(queue))
+      std::this_thread::yield();
+  if (group.error)
+    std::rethrow_exception(group.error);
+}
+
+int WorkStealingPool::threadIndex() const {
+  return currentPool == this ? currentQueue : 0;
+}
+
+bool WorkStealingPool::runOne(int self) {
+  std::pair<Group *, Task> task;
+  bool stolen = false;
+  {
+    Queue &own = *queues[self];
+    const std::lock_guard lock{own.mutex};
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+  for (std::size_t i = 1; !task.first && i < queues.size(); ++i) {
+    Queue &victim = *queues[(self + i) % queues.size()];
+    const std::lock_guard lock{victim.mutex};
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      stolen = true;
+    }
+  }
+  if (!task.first)
+    return false;
+
+  if (stolen)
+    steals.fetch_add(1, std::memory_order_relaxed);
+  Group &group = *task.first;
+  try {
+    task.second();
+  } catch (...) {
+    if (!group.failed.exchange(true))
+      group.error = std::current_exception();
+  }
+  group.pending.fetch_sub(1, std::memory_order_release);
+  return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * A thread pool for divide and conquer work, such as the siblings of a
+ * search node.
+ *
+ * Each thread queues the tasks it submits on its own queue and takes them
+ * back newest first, which keeps it working on the subtree it is already in.
+ * Idle threads steal the oldest task of another thread, which is usually the
+ * biggest one left. A thread waiting for its tasks keeps running queued tasks
+ * rather than blocking, so no thread sits idle while there is work.
+ *
+ * The thread that constructs the pool counts as one of its threads and is
+ * the only outside thread that may submit tasks.
+ */
+class WorkStealingPool {
+public:
+  using Task = std::function<void()>;
+
+  /**
+   * The tasks that one WorkStealingPool::wait call waits for
+   */
+  class Group {
+    friend class WorkStealingPool;
+    std::atomic_int pending = 0;
+    std::atomic_bool failed = false;
+    std::exception_ptr error;
+  };
+
+  /**
+   * @param threads The number of threads including the calling one, which
+   * only works on tasks while it waits
+   */
+  explicit WorkStealingPool(int threads);
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  ~WorkStealingPool();
+
+  void submit(Group &group, Task task);
+
+  /**
+   * Runs tasks until every task of the group is done, then rethrows the
+   * first exception one of them threw
+   * @param group
+   */
+  void wait(Group &group);
+
+  /**
+   * @return How many tasks ran on another thread than the one that
+   * submitted them
+   */
+  [[nodiscard]] std::uint64_t stealCount() const { return steals; }
+
+  /**
+   * @return The index of the calling thread among the threads of the pool,
+   * 0 for the thread that constructed it
+   */
+  [[nodiscard]] int threadIndex() const;
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::pair<Group *, Task>> tasks;
+  };
+
+  /**
+   * Runs the newest task of the thread's own queue, or steals one
+   * @return Whether a task ran
+   */
+  bool runOne(int self);
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::atomic_uint64_t steals = 0;
+  std::vector<std::jthread> workers;
+};
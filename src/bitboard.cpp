@@ -0,0 +1,49 @@
+#include "bitboard.hpp"
+#include <immintrin.h>
+
+namespace bitboard {
+__attribute__((target("avx2"))) Bitboard legalMovesAvx2(Bitboard player,
+                                                         Bitboard opponent) {
+  const auto inner =
+      static_cast<long long>(opponent & Geometry<boardSize>::innerColumns);
+  const __m256i shifts = _mm256_set_epi64x(9, 7, 8, 1);
+  const __m256i masks = _mm256_set_epi64x(
+      inner, inner, static_cast<long long>(opponent), inner);
+  const __m256i players = _mm256_set1_epi64x(static_cast<long long>(player));
+
+  __m256i up = _mm256_and_si256(masks, _mm256_sllv_epi64(players, shifts));
+  __m256i down = _mm256_and_si256(masks, _mm256_srlv_epi64(players, shifts));
+  for (int i = 0; i < 5; ++i) {
+    up = _mm256_or_si256(
+        up, _mm256_and_si256(masks, _mm256_sllv_epi64(up, shifts)));
+    down = _mm256_or_si256(
+        down, _mm256_and_si256(masks, _mm256_srlv_epi64(down, shifts)));
+  }
+  const __m256i moves = _mm256_or_si256(_mm256_sllv_epi64(up, shifts),
+                                        _mm256_srlv_epi64(down, shifts));
+
+  __m128i folded = _mm_or_si128(_mm256_castsi256_si128(moves),
+                                _mm256_extracti128_si256(moves, 1));
+  folded = _mm_or_si128(folded, _mm_unpackhi_epi64(folded, folded));
+  return static_cast<Bitboard>(_mm_cvtsi128_si64(folded)) &
+         ~(player | opponent);
+}
+
+namespace {
+using Kernel = Bitboard (*)(Bitboard, Bitboard);
+
+Kernel selectKernel() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return legalMovesAvx2;
+  return [](Bitboard player, Bitboard opponent) {
+    return legalMovesScalar(player, opponent);
+  };
+}
+} // namespace
+
+Bitboard detail::dispatchLegalMoves(Bitboard player, Bitboard opponent) {
+  static const Kernel kernel = selectKernel();
+  return kernel(player, opponent);
+}
+} // namespace bitboard
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Move generation kernels working on whole boards at once.
+ *
+ * A bitboard has one bit per square, numbered row by row (see
+ * bitboard::square). Instead of walking rays square by square, the kernels
+ * shift every disc of one color one step in a direction and keep the squares
+ * that land on an opponent disc, repeating until the longest possible run is
+ * covered. Doing that for all eight directions yields every legal move in a
+ * fixed number of branch free operations.
+ *
+ * Everything is parameterized on the board size N. Boards up to 8x8 fit in a
+ * 64-bit word, larger ones use a 128-bit word. The masks each size needs are
+ * generated at compile time by bitboard::Geometry.
+ */
+namespace bitboard {
+__extension__ using Bitboard128 = unsigned __int128;
+
+template <int N>
+using BasicBitboard =
+    std::conditional_t<(N * N <= 64), std::uint64_t, Bitboard128>;
+
+/** The standard board size */
+inline constexpr int boardSize = 8;
+
+using Bitboard = BasicBitboard<boardSize>;
+
+/**
+ * Squares are numbered row by row, so x is the column and y is the row
+ * @param x
+ * @param y
+ * @return The index of the bit representing the square
+ */
+template <int N = boardSize> constexpr int square(int x, int y) {
+  return y * N + x;
+}
+
+constexpr int popcount(std::uint64_t bitboard) {
+  return std::popcount(bitboard);
+}
+
+constexpr int popcount(Bitboard128 bitboard) {
+  return std::popcount(static_cast<std::uint64_t>(bitboard)) +
+         std::popcount(static_cast<std::uint64_t>(bitboard >> 64));
+}
+
+constexpr int countrZero(std::uint64_t bitboard) {
+  return std::countr_zero(bitboard);
+}
+
+constexpr int countrZero(Bitboard128 bitboard) {
+  const auto low = static_cast<std::uint64_t>(bitboard);
+  const auto high = static_cast<std::uint64_t>(bitboard >> 64);
+  return low ? std::countr_zero(low) : 64 + std::countr_zero(high);
+}
+
+/**
+ * Removes the lowest set bit of a bitboard and returns its index
+ */
+template <class Bitboard> constexpr int popSquare(Bitboard &bitboard) {
+  const int square = countrZero(bitboard);
+  bitboard &= bitboard - 1;
+  return square;
+}
+
+/**
+ * The masks that depend on the board size, generated at compile time
+ * @tparam N The number of rows and columns
+ */
+template <int N> struct Geometry {
+  static_assert(N >= 4 && N % 2 == 0 && N * N <= 128,
+                "Unsupported board size");
+
+  using Bitboard = BasicBitboard<N>;
+
+  template <class Predicate>
+  static constexpr Bitboard squaresWhere(Predicate predicate) {
+    Bitboard bitboard = 0;
+    for (int y = 0; y < N; ++y)
+      for (int x = 0; x < N; ++x)
+        if (predicate(x, y))
+          bitboard |= Bitboard{1} << square<N>(x, y);
+    return bitboard;
+  }
+
+  /** Every square on the board */
+  static constexpr Bitboard full = squaresWhere([](int, int) { return true; });
+
+  /** Every square off the first and last column, stops rays wrapping */
+  static constexpr Bitboard innerColumns =
+      squaresWhere([](int x, int) { return x > 0 && x < N - 1; });
+
+  static constexpr Bitboard edges = squaresWhere([](int x, int y) {
+    return x == 0 || y == 0 || x == N - 1 || y == N - 1;
+  });
+
+  static constexpr Bitboard corners = squaresWhere([](int x, int y) {
+    return (x == 0 || x == N - 1) && (y == 0 || y == N - 1);
+  });
+
+  /** How far a square index moves for one step in each direction */
+  static constexpr std::array<int, 8> directions{
+      1, -1, N, -N, N - 1, -(N - 1), N + 1, -(N + 1)};
+};
+
+/**
+ * Shifts a bitboard one step towards higher square indices when shift is
+ * positive, towards lower ones when it is negative
+ */
+template <class Bitboard>
+constexpr Bitboard shift(Bitboard bitboard, int shift) {
+  return shift > 0 ? bitboard << shift : bitboard >> -shift;
+}
+
+/**
+ * The opponent discs that can sit inside a run in the given direction.
+ * Anything but a vertical run has to stay off the edge columns.
+ * @param opponent
+ * @return
+ */
+template <int N, int Direction>
+constexpr BasicBitboard<N> runMask(BasicBitboard<N> opponent) {
+  if constexpr (Direction == N || Direction == -N)
+    return opponent;
+  else
+    return opponent & Geometry<N>::innerColumns;
+}
+
+/**
+ * Collects the longest run of masked squares starting next to the given
+ * squares. N - 2 steps cover the longest run that fits between two discs.
+ *
+ * The direction and the step count are template parameters so that every
+ * size gets a fully unrolled kernel with constant shifts.
+ */
+template <int N, int Direction>
+constexpr BasicBitboard<N> fill(BasicBitboard<N> from, BasicBitboard<N> mask) {
+  BasicBitboard<N> run = mask & shift(from, Direction);
+  [&]<std::size_t... Step>(std::index_sequence<Step...>) {
+    ((static_cast<void>(Step), run |= mask & shift(run, Direction)), ...);
+  }(std::make_index_sequence<N - 3>{});
+  return run;
+}
+
+/**
+ * Calls the function once per direction, passing the direction as a
+ * std::integral_constant
+ */
+template <int N, class Function>
+constexpr void forEachDirection(Function function) {
+  [&]<std::size_t... I>(std::index_sequence<I...>) {
+    (function(std::integral_constant<int, Geometry<N>::directions[I]>{}), ...);
+  }(std::make_index_sequence<Geometry<N>::directions.size()>{});
+}
+
+/**
+ * The portable implementation of bitboard::legalMoves
+ */
+template <int N = boardSize>
+constexpr BasicBitboard<N> legalMovesScalar(BasicBitboard<N> player,
+                                            BasicBitboard<N> opponent) {
+  BasicBitboard<N> moves = 0;
+  forEachDirection<N>([&](auto direction) {
+    moves |= shift(fill<N, direction>(player, runMask<N, direction>(opponent)),
+                   direction);
+  });
+  return moves & ~(player | opponent) & Geometry<N>::full;
+}
+
+/**
+ * Runs the four directions that shift towards higher squares in one AVX2
+ * register and the four mirrored ones in another. Only call it when the CPU
+ * supports AVX2, and only for 8x8 boards.
+ */
+Bitboard legalMovesAvx2(Bitboard player, Bitboard opponent);
+
+namespace detail {
+/**
+ * The 8x8 kernel picked for the running CPU
+ */
+Bitboard dispatchLegalMoves(Bitboard player, Bitboard opponent);
+} // namespace detail
+
+/**
+ * Finds every square the player can move to.
+ *
+ * On 8x8 boards this picks the AVX2 kernel when the running CPU has it and
+ * falls back to bitboard::legalMovesScalar otherwise.
+ * @param player The discs of the side to move
+ * @param opponent The discs of the other side
+ * @return A bitboard with one bit set per legal move
+ */
+template <int N = boardSize>
+BasicBitboard<N> legalMoves(BasicBitboard<N> player,
+                            BasicBitboard<N> opponent) {
+  if constexpr (N == boardSize)
+    return detail::dispatchLegalMoves(player, opponent);
+  else
+    return legalMovesScalar<N>(player, opponent);
+}
+
+/**
+ * Finds the discs that flip when the player moves on the given square
+ * @param square The index of an empty square
+ * @param player The discs of the side to move
+ * @param opponent The discs of the other side
+ * @return The flipped discs, empty if the move is illegal
+ */
+template <int N = boardSize>
+constexpr BasicBitboard<N> flips(int square, BasicBitboard<N> player,
+                                 BasicBitboard<N> opponent) {
+  using Bitboard = BasicBitboard<N>;
+  const Bitboard move = Bitboard{1} << square;
+  Bitboard flipped = 0;
+  forEachDirection<N>([&](auto direction) {
+    const Bitboard run =
+        fill<N, direction>(move, runMask<N, direction>(opponent));
+    // the run is only captured when a disc of the player closes it off
+    const bool bracketed = (shift(run, direction) & player) != 0;
+    flipped |= run & (Bitboard{0} - bracketed);
+  });
+  return flipped;
+}
+} // namespace bitboard
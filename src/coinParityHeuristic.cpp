@@ -1,11 +1,26 @@
 #include "coinParityHeuristic.hpp"
 #include "Othello.hpp"
+#include <algorithm>
 
 double coinParityHeuristic(const Othello &othello) {
-  auto [blackCoins, whiteCoins] = othello.score();
+  const int blackCoins = othello.blackCount();
+  const int whiteCoins = othello.whiteCount();
   if (whiteCoins == blackCoins)
     return 0;
   double blackScore =
       100 * (double)(blackCoins - whiteCoins) / (blackCoins + whiteCoins);
   return othello.isBlackTurn() ? blackScore : -blackScore;
 }
+
+void coinParityHeuristicBatch(std::span<const Othello> positions,
+                              std::span<double> scores) {
+  // no early return and no branches, a tie simply leads by 0
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    const Othello &othello = positions[i];
+    const int blackCoins = othello.blackCount();
+    const int whiteCoins = othello.whiteCount();
+    const int lead = othello.isBlackTurn() ? blackCoins - whiteCoins
+                                           : whiteCoins - blackCoins;
+    scores[i] = 100 * (double)lead / std::max(blackCoins + whiteCoins, 1);
+  }
+}
@@ -1,5 +1,12 @@
 #pragma once
 
-class Othello;
+#include "HeuristicFunction.hpp"
+#include "OthelloFwd.hpp"
 
 double coinParityHeuristic(const Othello &othello);
+
+/**
+ * Scores the positions like coinParityHeuristic, in a loop without branches
+ */
+void coinParityHeuristicBatch(std::span<const Othello> positions,
+                              std::span<double> scores);
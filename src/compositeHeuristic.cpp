@@ -4,17 +4,40 @@
 #include "cornerHeuristic.hpp"
 #include "mobilityHeuristic.hpp"
 #include "stabilityHeuristic.hpp"
+#include <algorithm>
+#include <array>
 
 namespace {
-int piecesOnBoard(const Othello &othello) {
-  const auto score = othello.score();
-  return score.first + score.second;
-}
+/** How many positions compositeHeuristicBatch scores per pass */
+constexpr std::size_t chunkSize = 64;
 } // namespace
 
 double compositeHeuristic(const Othello &othello) {
   return 10 * coinParityHeuristic(othello) +
          // only consider corners in first 40 moves
-         (piecesOnBoard(othello) <= 40 ? 500 * cornerHeuristic(othello) : 0) +
+         (othello.discCount() <= 40 ? 500 * cornerHeuristic(othello) : 0) +
          80 * mobilityHeuristic(othello) + 50 * stabilityHeuristic(othello);
 }
+
+void compositeHeuristicBatch(std::span<const Othello> positions,
+                             std::span<double> scores) {
+  std::array<double, chunkSize> coinParity;
+  std::array<double, chunkSize> corners;
+  std::array<double, chunkSize> mobility;
+  std::array<double, chunkSize> stability;
+  // every part is scored for a whole chunk at once, then the parts are
+  // weighed like compositeHeuristic does
+  for (std::size_t start = 0; start < positions.size(); start += chunkSize) {
+    const std::span<const Othello> chunk =
+        positions.subspan(start, std::min(chunkSize, positions.size() - start));
+    coinParityHeuristicBatch(chunk, coinParity);
+    cornerHeuristicBatch(chunk, corners);
+    mobilityHeuristicBatch(chunk, mobility);
+    stabilityHeuristicBatch(chunk, stability);
+    for (std::size_t i = 0; i < chunk.size(); ++i)
+      scores[start + i] =
+          10 * coinParity[i] +
+          (chunk[i].discCount() <= 40 ? 500 * corners[i] : 0) +
+          80 * mobility[i] + 50 * stability[i];
+  }
+}
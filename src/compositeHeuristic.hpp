@@ -1,5 +1,13 @@
 #pragma once
 
-class Othello;
+#include "HeuristicFunction.hpp"
+#include "OthelloFwd.hpp"
 
 double compositeHeuristic(const Othello &othello);
+
+/**
+ * Scores the positions like compositeHeuristic, every part of the score for
+ * many positions at a time
+ */
+void compositeHeuristicBatch(std::span<const Othello> positions,
+                             std::span<double> scores);
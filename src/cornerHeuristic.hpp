@@ -1,5 +1,13 @@
 #pragma once
 
-class Othello;
+#include "HeuristicFunction.hpp"
+#include "OthelloFwd.hpp"
 
 double cornerHeuristic(const Othello &othello);
+
+/**
+ * Scores the positions like cornerHeuristic, counting the corners of
+ * every position with a mask
+ */
+void cornerHeuristicBatch(std::span<const Othello> positions,
+                          std::span<double> scores);
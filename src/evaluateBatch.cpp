@@ -0,0 +1,36 @@
+#include "evaluateBatch.hpp"
+#include "Othello.hpp"
+#include "coinParityHeuristic.hpp"
+#include "compositeHeuristic.hpp"
+#include "cornerHeuristic.hpp"
+#include "mobilityHeuristic.hpp"
+#include "stabilityHeuristic.hpp"
+#include <array>
+#include <utility>
+
+namespace {
+constexpr std::array<std::pair<HeuristicFunction, BatchHeuristicFunction>, 5>
+    batchVersions{{{coinParityHeuristic, coinParityHeuristicBatch},
+                   {mobilityHeuristic, mobilityHeuristicBatch},
+                   {cornerHeuristic, cornerHeuristicBatch},
+                   {stabilityHeuristic, stabilityHeuristicBatch},
+                   {compositeHeuristic, compositeHeuristicBatch}}};
+} // namespace
+
+BatchHeuristicFunction batchHeuristic(HeuristicFunction heuristic) {
+  for (const auto &[function, batch] : batchVersions)
+    if (function == heuristic)
+      return batch;
+  return nullptr;
+}
+
+void evaluateBatch(HeuristicFunction heuristic,
+                   std::span<const Othello> positions,
+                   std::span<double> scores) {
+  if (const BatchHeuristicFunction batch = batchHeuristic(heuristic)) {
+    batch(positions, scores);
+    return;
+  }
+  for (std::size_t i = 0; i < positions.size(); ++i)
+    scores[i] = heuristic(positions[i]);
+}
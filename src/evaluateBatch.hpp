@@ -0,0 +1,22 @@
+#pragma once
+
+#include "HeuristicFunction.hpp"
+#include "OthelloFwd.hpp"
+
+/**
+ * @param heuristic
+ * @return The batch version of a built in heuristic, nullptr for any other
+ */
+BatchHeuristicFunction batchHeuristic(HeuristicFunction heuristic);
+
+/**
+ * Scores every position with the heuristic, in a single call to its batch
+ * version when it has one and otherwise one position at a time
+ * @param heuristic
+ * @param positions
+ * @param scores Where the score of positions[i] goes to scores[i], with room
+ * for every position
+ */
+void evaluateBatch(HeuristicFunction heuristic,
+                   std::span<const Othello> positions,
+                   std::span<double> scores);
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Othello.hpp"
+
+/**
+ * Finished games are scored beyond the reach of any heuristic, but low
+ * enough that the transposition table still stores the exact disc margin
+ */
+inline constexpr double winScore = 1e6;
+
+/**
+ * Scores a finished or solved game, preferring bigger wins. Every search
+ * that scores finished games does it this way, so that its scores compare
+ * with the heuristic scores of the others.
+ * @param discDifference The final discs of the side to move minus those of
+ * the opponent
+ * @return 0 for a draw, winScore plus the difference for a win and minus
+ * winScore plus the difference for a loss
+ */
+constexpr double gameOverScore(int discDifference) {
+  if (discDifference == 0)
+    return 0;
+  return (discDifference > 0 ? winScore : -winScore) + discDifference;
+}
+
+/**
+ * @param othello A finished game
+ * @return Its score for the side to move
+ */
+inline double gameOverScore(const Othello &othello) {
+  return gameOverScore(othello.isBlackTurn()
+                           ? othello.blackCount() - othello.whiteCount()
+                           : othello.whiteCount() - othello.blackCount());
+}
@@ -0,0 +1,22 @@
+#include "heuristicByName.hpp"
+#include "coinParityHeuristic.hpp"
+#include "compositeHeuristic.hpp"
+#include "mobilityHeuristic.hpp"
+#include "stabilityHeuristic.hpp"
+#include <array>
+#include <utility>
+
+namespace {
+constexpr std::array<std::pair<std::string_view, HeuristicFunction>, 4>
+    heuristics{{{"coin", coinParityHeuristic},
+                {"mobility", mobilityHeuristic},
+                {"stability", stabilityHeuristic},
+                {"composite", compositeHeuristic}}};
+} // namespace
+
+HeuristicFunction heuristicByName(std::string_view name) {
+  for (const auto &[heuristicName, heuristic] : heuristics)
+    if (heuristicName == name)
+      return heuristic;
+  return nullptr;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "HeuristicFunction.hpp"
+#include <string_view>
+
+/** The names heuristicByName knows, the way a usage message lists them */
+inline constexpr std::string_view heuristicNames =
+    "coin|mobility|stability|composite";
+
+/**
+ * @param name One of heuristicNames
+ * @return The heuristic of that name, nullptr for an unknown name
+ */
+HeuristicFunction heuristicByName(std::string_view name);
@@ -1,14 +1,25 @@
 #include "mobilityHeuristic.hpp"
 #include "Othello.hpp"
+#include <algorithm>
+#include <bit>
 
 double mobilityHeuristic(const Othello &othello) {
-  int emptySpaces = 0;
-  for (const auto &column : othello.boardState())
-    for (const auto &cell : column)
-      if (cell == Othello::State::EMPTY)
-        ++emptySpaces;
+  const int emptySpaces = othello.emptyCount();
   if (emptySpaces == 0)
     return 0;
-  return 100 * (double)(emptySpaces - othello.legalMoves().size()) /
+  return 100 * (double)(emptySpaces - std::popcount(othello.legalMoveMask())) /
          emptySpaces;
 }
+
+void mobilityHeuristicBatch(std::span<const Othello> positions,
+                            std::span<double> scores) {
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    const Othello &othello = positions[i];
+    const int emptySpaces = othello.emptyCount();
+    // a full board has no moves either, so it scores 0 / 1 rather than
+    // taking a branch
+    scores[i] = 100 *
+                (double)(emptySpaces - std::popcount(othello.legalMoveMask())) /
+                std::max(emptySpaces, 1);
+  }
+}
@@ -1,5 +1,12 @@
 #pragma once
 
-class Othello;
+#include "HeuristicFunction.hpp"
+#include "OthelloFwd.hpp"
 
 double mobilityHeuristic(const Othello &othello);
+
+/**
+ * Scores the positions like mobilityHeuristic
+ */
+void mobilityHeuristicBatch(std::span<const Othello> positions,
+                            std::span<double> scores);
@@ -31,10 +31,13 @@ using State =
  * @param state
  */
 void markUnstablePieces(const Othello &othello, State &state) {
-  for (const auto &[move, captures] : othello.legalMoves()) {
-    for (const auto &capture : captures) {
-      state[capture.first][capture.second] = Stability::UNSTABLE;
-    }
+  Othello::Bitboard captures = 0;
+  for (const LegalMove &move : othello.legalMoves())
+    captures |= move.flips;
+  while (captures) {
+    const int capture = bitboard::popSquare(captures);
+    state[capture % Othello::boardSize][capture / Othello::boardSize] =
+        Stability::UNSTABLE;
   }
 }
 
@@ -193,7 +196,7 @@ std::pair<int, int> tallyScore(const Othello &othello, const State &state) {
         points = 1;
         break;
       }
-      switch (othello.boardState()[i][j]) {
+      switch (othello.at(i, j)) {
       case Othello::State::BLACK:
         blackPoints += points;
         break;
@@ -212,19 +215,20 @@ std::pair<int, int> tallyScore(const Othello &othello, const State &state) {
 
 double stabilityHeuristic(const Othello &othello) {
   State state{};
+  const Othello::BoardState boardState = othello.boardState();
   markUnstablePieces(othello, state);
-  markEdgesAsStable(othello.boardState(), state);
+  markEdgesAsStable(boardState, state);
 
   bool madeChange;
   do {
     madeChange = false;
     for (int i = 1; i < Othello::boardSize - 1; ++i) {
       for (int j = 1; j < Othello::boardSize - 1; ++j) {
-        if (othello.boardState()[i][j] == Othello::State::EMPTY)
+        if (boardState[i][j] == Othello::State::EMPTY)
           continue;
         if (state[i][j] != Stability::SEMI_STABLE)
           continue;
-        if (checkIfPieceIsStable(othello.boardState(), state, i, j)) {
+        if (checkIfPieceIsStable(boardState, state, i, j)) {
           state[i][j] = Stability::STABLE;
           madeChange = true;
         }
@@ -239,3 +243,11 @@ double stabilityHeuristic(const Othello &othello) {
       100 * (double)(blackPoints - whitePoints) / (blackPoints + whitePoints);
   return othello.isBlackTurn() ? blackPoints : -blackScore;
 }
+
+void stabilityHeuristicBatch(std::span<const Othello> positions,
+                             std::span<double> scores) {
+  // the stability of a disc depends on its neighbours, which is work for one
+  // position at a time
+  for (std::size_t i = 0; i < positions.size(); ++i)
+    scores[i] = stabilityHeuristic(positions[i]);
+}
@@ -1,5 +1,13 @@
 #pragma once
 
-class Othello;
+#include "HeuristicFunction.hpp"
+#include "OthelloFwd.hpp"
 
 double stabilityHeuristic(const Othello &othello);
+
+/**
+ * Scores the positions one at a time with stabilityHeuristic, so that it
+ * can stand in wherever the batch versions are used
+ */
+void stabilityHeuristicBatch(std::span<const Othello> positions,
+                             std::span<double> scores);
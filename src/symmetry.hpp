@@ -0,0 +1,155 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include <array>
+#include <utility>
+
+/**
+ * The eight symmetries of the board (the dihedral group of the square) and
+ * bitboard kernels that apply them to every square at once.
+ *
+ * Each symmetry is named after what it does to a square (x, y), where n is
+ * the last row or column:
+ * - ROTATE_90: (n - y, x)
+ * - ROTATE_180: (n - x, n - y)
+ * - ROTATE_270: (y, n - x)
+ * - MIRROR_X: (n - x, y)
+ * - MIRROR_Y: (x, n - y)
+ * - TRANSPOSE: (y, x)
+ * - ANTI_TRANSPOSE: (n - y, n - x)
+ *
+ * 8x8 boards use dedicated shift and mask kernels, other sizes move the discs
+ * one at a time.
+ */
+namespace symmetry {
+using bitboard::Bitboard;
+
+enum class Symmetry {
+  IDENTITY,
+  ROTATE_90,
+  ROTATE_180,
+  ROTATE_270,
+  MIRROR_X,
+  MIRROR_Y,
+  TRANSPOSE,
+  ANTI_TRANSPOSE
+};
+
+inline constexpr std::array<Symmetry, 8> all{
+    Symmetry::IDENTITY,   Symmetry::ROTATE_90, Symmetry::ROTATE_180,
+    Symmetry::ROTATE_270, Symmetry::MIRROR_X,  Symmetry::MIRROR_Y,
+    Symmetry::TRANSPOSE,  Symmetry::ANTI_TRANSPOSE};
+
+/**
+ * @return The symmetry that undoes the given one
+ */
+constexpr Symmetry inverse(Symmetry symmetry) {
+  switch (symmetry) {
+  case Symmetry::ROTATE_90:
+    return Symmetry::ROTATE_270;
+  case Symmetry::ROTATE_270:
+    return Symmetry::ROTATE_90;
+  default:
+    return symmetry;
+  }
+}
+
+/** Reverses the order of the columns */
+constexpr Bitboard mirrorX(Bitboard b) {
+  b = ((b >> 1) & 0x5555555555555555) | ((b & 0x5555555555555555) << 1);
+  b = ((b >> 2) & 0x3333333333333333) | ((b & 0x3333333333333333) << 2);
+  return ((b >> 4) & 0x0F0F0F0F0F0F0F0F) | ((b & 0x0F0F0F0F0F0F0F0F) << 4);
+}
+
+/** Reverses the order of the rows */
+constexpr Bitboard mirrorY(Bitboard b) { return __builtin_bswap64(b); }
+
+/** Swaps rows and columns */
+constexpr Bitboard transpose(Bitboard b) {
+  Bitboard t = 0x0F0F0F0F00000000 & (b ^ (b << 28));
+  b ^= t ^ (t >> 28);
+  t = 0x3333000033330000 & (b ^ (b << 14));
+  b ^= t ^ (t >> 14);
+  t = 0x5500550055005500 & (b ^ (b << 7));
+  return b ^ t ^ (t >> 7);
+}
+
+/** Reflects across the diagonal from the top right to the bottom left */
+constexpr Bitboard antiTranspose(Bitboard b) {
+  Bitboard t = b ^ (b << 36);
+  b ^= 0xF0F0F0F00F0F0F0F & (t ^ (b >> 36));
+  t = 0xCCCC0000CCCC0000 & (b ^ (b << 18));
+  b ^= t ^ (t >> 18);
+  t = 0xAA00AA00AA00AA00 & (b ^ (b << 9));
+  return b ^ t ^ (t >> 9);
+}
+
+/**
+ * Maps the coordinates of a single square
+ * @param x
+ * @param y
+ * @param symmetry
+ * @return The coordinates of the square after the symmetry is applied
+ */
+template <int N = bitboard::boardSize>
+constexpr std::pair<int, int> transform(int x, int y, Symmetry symmetry) {
+  constexpr int n = N - 1;
+  switch (symmetry) {
+  case Symmetry::IDENTITY:
+    return {x, y};
+  case Symmetry::ROTATE_90:
+    return {n - y, x};
+  case Symmetry::ROTATE_180:
+    return {n - x, n - y};
+  case Symmetry::ROTATE_270:
+    return {y, n - x};
+  case Symmetry::MIRROR_X:
+    return {n - x, y};
+  case Symmetry::MIRROR_Y:
+    return {x, n - y};
+  case Symmetry::TRANSPOSE:
+    return {y, x};
+  case Symmetry::ANTI_TRANSPOSE:
+    return {n - y, n - x};
+  }
+  return {x, y};
+}
+
+template <int N = bitboard::boardSize>
+constexpr int transformSquare(int square, Symmetry symmetry) {
+  const auto [x, y] = transform<N>(square % N, square / N, symmetry);
+  return bitboard::square<N>(x, y);
+}
+
+template <int N = bitboard::boardSize>
+constexpr bitboard::BasicBitboard<N>
+transform(bitboard::BasicBitboard<N> b, Symmetry symmetry) {
+  if constexpr (N != bitboard::boardSize) {
+    bitboard::BasicBitboard<N> transformed = 0;
+    while (b)
+      transformed |= bitboard::BasicBitboard<N>{1}
+                     << transformSquare<N>(bitboard::popSquare(b), symmetry);
+    return transformed;
+  } else {
+    switch (symmetry) {
+    case Symmetry::IDENTITY:
+      return b;
+    case Symmetry::ROTATE_90:
+      return mirrorX(transpose(b));
+    case Symmetry::ROTATE_180:
+      return mirrorY(mirrorX(b));
+    case Symmetry::ROTATE_270:
+      return mirrorY(transpose(b));
+    case Symmetry::MIRROR_X:
+      return mirrorX(b);
+    case Symmetry::MIRROR_Y:
+      return mirrorY(b);
+    case Symmetry::TRANSPOSE:
+      return transpose(b);
+    case Symmetry::ANTI_TRANSPOSE:
+      return antiTranspose(b);
+    }
+    return b;
+  }
+}
+} // namespace symmetry
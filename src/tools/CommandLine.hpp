@@ -0,0 +1,82 @@
+#pragma once
+
+#include "HeuristicFunction.hpp"
+#include "heuristicByName.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/**
+ * Reads the options of the tools, which all stop with their usage message
+ * at the first option they cannot make sense of
+ */
+class CommandLine {
+public:
+  /**
+   * @param argc
+   * @param argv
+   * @param usage The usage message, starting with "Usage: "
+   */
+  CommandLine(int argc, char *argv[], std::string usage)
+      : argc{argc}, argv{argv}, usageText{std::move(usage)} {}
+
+  /**
+   * Prints the error and the usage message and exits
+   * @param error
+   */
+  [[noreturn]] void usage(std::string_view error) const {
+    std::cerr << error << "\n" << usageText << "\n";
+    std::exit(2);
+  }
+
+  [[nodiscard]] int size() const { return argc; }
+
+  [[nodiscard]] std::string_view operator[](int i) const { return argv[i]; }
+
+  /**
+   * Moves on to the value of the option at i
+   * @param i The index of the option, the index of the value afterwards
+   * @return
+   */
+  std::string_view value(int &i) const {
+    if (++i >= argc)
+      usage(std::string{argv[i - 1]} + " needs a value");
+    return argv[i];
+  }
+
+  /**
+   * @param i The index of the option, the index of the value afterwards
+   * @return The value of the option, a positive number
+   */
+  int positiveNumber(int &i) const {
+    const std::string arg{value(i)};
+    try {
+      const int number = std::stoi(arg);
+      if (number < 1)
+        usage("Expected a positive number: " + arg);
+      return number;
+    } catch (const std::logic_error &) {
+      usage("Not a number: " + arg);
+    }
+  }
+
+  /**
+   * @param i The index of the option, the index of the value afterwards
+   * @return The heuristic the value names, see heuristicByName
+   */
+  HeuristicFunction heuristic(int &i) const {
+    const std::string_view name = value(i);
+    const HeuristicFunction heuristic = heuristicByName(name);
+    if (!heuristic)
+      usage("Unknown heuristic " + std::string{name});
+    return heuristic;
+  }
+
+private:
+  const int argc;
+  char **const argv;
+  const std::string usageText;
+};
@@ -0,0 +1,429 @@
+/**
+ * othello_bookgen: builds the opening book the AIs read, see OpeningBook.
+ *
+ * Every position up to the given number of plies from the start is
+ * collected once, however many symmetric copies and transpositions lead to
+ * it. The last ply is searched to a fixed depth by one search per core, and
+ * the scores are backed up to the start with negamax. Every move of every
+ * position before the last ply becomes a record, and so does the best move
+ * of each searched position.
+ *
+ * The scores of the searched positions go to a checkpoint file as soon as
+ * they are known. Running the tool again with the same options skips them,
+ * so an interrupted run, say by Ctrl+C, loses at most the searches that
+ * were in progress.
+ *
+ * Usage: othello_bookgen [options]
+ *   --plies P          How deep the book reaches, 8 by default
+ *   --depth D          The depth to search the last ply to, 12 by default
+ *   --threads T        How many positions to search at once, one per core
+ *                      by default
+ *   --heuristic H      coin, mobility, stability or composite, the default
+ *   --output FILE      Where to write the book, othello.book by default
+ *   --checkpoint FILE  Where to keep the searched positions, the output
+ *                      with .checkpoint appended by default
+ */
+#include "CommandLine.hpp"
+#include "MinMaxStrategy.hpp"
+#include "OpeningBook.hpp"
+#include "Othello.hpp"
+#include "compositeHeuristic.hpp"
+#include "gameOverScore.hpp"
+#include "heuristicByName.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/exception/diagnostic_information.hpp>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+std::atomic_bool interrupted = false;
+
+extern "C" void signalHandler(int) { interrupted = true; }
+
+struct Options {
+  int plies = 8;
+  int depth = 12;
+  int threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  std::string heuristicName = "composite";
+  HeuristicFunction heuristic = compositeHeuristic;
+  std::filesystem::path output = "othello.book";
+  std::filesystem::path checkpoint{};
+};
+
+Options parseOptions(int argc, char *argv[]) {
+  const CommandLine commandLine{
+      argc, argv,
+      "Usage: othello_bookgen [--plies P] [--depth D] [--threads T]"
+      " [--heuristic " +
+          std::string{heuristicNames} +
+          "] [--output FILE] [--checkpoint FILE]"};
+  Options options;
+  for (int i = 1; i < commandLine.size(); ++i) {
+    const std::string_view arg = commandLine[i];
+    if (arg == "--plies") {
+      options.plies = commandLine.positiveNumber(i);
+    } else if (arg == "--depth") {
+      options.depth = commandLine.positiveNumber(i);
+    } else if (arg == "--threads") {
+      options.threads = commandLine.positiveNumber(i);
+    } else if (arg == "--heuristic") {
+      options.heuristic = commandLine.heuristic(i);
+      options.heuristicName = commandLine[i];
+    } else if (arg == "--output") {
+      options.output = commandLine.value(i);
+    } else if (arg == "--checkpoint") {
+      options.checkpoint = commandLine.value(i);
+    } else {
+      commandLine.usage("Unknown option " + std::string{arg});
+    }
+  }
+  if (options.checkpoint.empty()) {
+    options.checkpoint = options.output;
+    options.checkpoint += ".checkpoint";
+  }
+  return options;
+}
+
+/**
+ * A move of a book position, to the canonical form of where it leads
+ */
+struct Edge {
+  /** In the coordinates of the canonical position the move is played in */
+  int square;
+  zobrist::Key child;
+  /** Whether the opponent has to pass, so the same side moves again */
+  bool sameSide;
+};
+
+/**
+ * A position of the book, stored in its canonical form
+ */
+struct Node {
+  Othello position;
+  /** Empty for the positions that are searched */
+  std::vector<Edge> edges{};
+  double score = 0;
+  /** The book lines through the position, transpositions count each time */
+  std::uint64_t lines = 0;
+};
+
+/**
+ * What the search of a position on the last ply found out
+ */
+struct Evaluation {
+  zobrist::Key hash;
+  double score;
+  /** -1 when the game is over */
+  std::int32_t square;
+  std::int32_t unused = 0;
+};
+
+/**
+ * Collects every position up to the given ply once. A forced pass is made
+ * on the spot, passes add no disc so every path reaches a position at the
+ * same ply.
+ * @param plies
+ * @param leaves Where to put the positions to search
+ * @return The positions by their hash
+ */
+std::unordered_map<zobrist::Key, Node>
+collectPositions(int plies, std::vector<zobrist::Key> &leaves) {
+  std::unordered_map<zobrist::Key, Node> nodes;
+  const Othello start = Othello{}.canonical().position;
+  nodes.emplace(start.hash(), Node{start});
+  std::vector<zobrist::Key> ply{start.hash()};
+  for (int depth = 0; depth < plies; ++depth) {
+    std::vector<zobrist::Key> next;
+    for (const zobrist::Key hash : ply) {
+      const Othello position = nodes.at(hash).position;
+      std::vector<Edge> edges;
+      for (const LegalMove &move : position.legalMoves()) {
+        Othello child = position;
+        child.doMove(move);
+        if (!child.legalMoveMask()) {
+          child.doPass();
+          // neither side can move, the game is over
+          if (!child.legalMoveMask())
+            child.doPass();
+        }
+        const Othello canonical = child.canonical().position;
+        edges.push_back({move.square, canonical.hash(),
+                         child.isBlackTurn() == position.isBlackTurn()});
+        if (nodes.emplace(canonical.hash(), Node{canonical}).second)
+          next.push_back(canonical.hash());
+      }
+      nodes.at(hash).edges = std::move(edges);
+    }
+    ply = std::move(next);
+  }
+  // the last ply, and the games that ended before it
+  for (const auto &[hash, node] : nodes)
+    if (node.edges.empty())
+      leaves.push_back(hash);
+  std::ranges::sort(leaves);
+  return nodes;
+}
+
+/**
+ * The searches finished so far, in a file that only ever grows, so that a
+ * crash in the middle of a write loses that one search at most
+ */
+class Checkpoint {
+public:
+  /**
+   * Reads what a previous run of the same options left, and continues it
+   * @param options
+   * @param evaluations Where to put the searches of the previous run
+   */
+  Checkpoint(const Options &options, std::vector<Evaluation> &evaluations) {
+    Header header{};
+    header.plies = options.plies;
+    header.depth = options.depth;
+    const std::string_view name = options.heuristicName;
+    std::ranges::copy(name.substr(0, header.heuristic.size() - 1),
+                      header.heuristic.begin());
+    std::size_t validSize = sizeof(Header);
+    if (std::filesystem::exists(options.checkpoint)) {
+      std::ifstream in{options.checkpoint, std::ios::binary};
+      Header stored{};
+      if (!in.read(reinterpret_cast<char *>(&stored), sizeof(stored)) ||
+          stored.magic != header.magic || stored.version != header.version)
+        throw std::runtime_error{options.checkpoint.string() +
+                                 " is no checkpoint of this tool"};
+      if (stored.plies != header.plies || stored.depth != header.depth ||
+          stored.heuristic != header.heuristic)
+        throw std::runtime_error{
+            options.checkpoint.string() +
+            " was made with other options, delete it to start over"};
+      Evaluation evaluation{};
+      while (in.read(reinterpret_cast<char *>(&evaluation), sizeof(evaluation)))
+        evaluations.push_back(evaluation);
+      // a partial record at the end is dropped, the next one goes in its place
+      validSize += evaluations.size() * sizeof(Evaluation);
+      in.close();
+      std::filesystem::resize_file(options.checkpoint, validSize);
+      file.open(options.checkpoint, std::ios::binary | std::ios::app);
+    } else {
+      file.open(options.checkpoint, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      file.flush();
+    }
+    if (!file)
+      throw std::runtime_error{"Cannot write " + options.checkpoint.string()};
+  }
+
+  /**
+   * Adds a search, callable from any thread
+   * @param evaluation
+   */
+  void add(const Evaluation &evaluation) {
+    const std::lock_guard lock{mutex};
+    file.write(reinterpret_cast<const char *>(&evaluation),
+               sizeof(evaluation));
+    file.flush();
+    if (!file)
+      throw std::runtime_error{"Cannot write the checkpoint"};
+  }
+
+private:
+  struct Header {
+    std::array<char, 8> magic{'O', 'T', 'H', 'B', 'G', 'E', 'N', 0};
+    std::uint32_t version = 1;
+    std::int32_t plies = 0;
+    std::int32_t depth = 0;
+    std::array<char, 12> heuristic{};
+  };
+
+  std::mutex mutex;
+  std::ofstream file;
+};
+
+/**
+ * Searches the positions on all threads, taking the next one off the list
+ * whenever a search is done, until all are done or the run is interrupted
+ * @param options
+ * @param nodes
+ * @param pending The positions to search
+ * @param checkpoint
+ * @param evaluations Where the searches go as well
+ * @return Whether every position was searched
+ */
+bool searchLeaves(const Options &options,
+                  const std::unordered_map<zobrist::Key, Node> &nodes,
+                  const std::vector<zobrist::Key> &pending,
+                  Checkpoint &checkpoint,
+                  std::vector<Evaluation> &evaluations) {
+  std::atomic_size_t next = 0;
+  std::atomic_size_t done = 0;
+  std::mutex mutex;
+  std::exception_ptr error;
+  std::stop_source stopSource;
+  const auto search = [&] {
+    MinMaxStrategy strategy{options.depth,
+                            MinMaxStrategy::Search::PRINCIPAL_VARIATION};
+    const SearchLimits limits{.maxDepth = options.depth,
+                              .stopToken = stopSource.get_token()};
+    for (std::size_t i = next++; i < pending.size(); i = next++) {
+      const Othello &position = nodes.at(pending[i]).position;
+      Evaluation evaluation{.hash = pending[i], .score = 0, .square = -1};
+      if (!position.legalMoveMask()) {
+        evaluation.score = gameOverScore(position);
+      } else {
+        const AI::Move move =
+            strategy.nextMove(options.heuristic, position, limits);
+        const PrincipalVariation &line = strategy.principalVariation();
+        // a stopped search did not reach the depth, leave it to the next run
+        if (line.depth < std::min(options.depth, position.emptyCount()))
+          return;
+        evaluation.score = line.score;
+        evaluation.square = bitboard::square(move.first, move.second);
+      }
+      checkpoint.add(evaluation);
+      {
+        const std::lock_guard lock{mutex};
+        evaluations.push_back(evaluation);
+      }
+      ++done;
+    }
+  };
+
+  const auto work = [&] {
+    try {
+      search();
+    } catch (...) {
+      {
+        const std::lock_guard lock{mutex};
+        if (!error)
+          error = std::current_exception();
+      }
+      // the other searches stop as if the run was interrupted
+      interrupted = true;
+    }
+  };
+  const auto start = std::chrono::steady_clock::now();
+  auto lastReport = start;
+  {
+    std::vector<std::jthread> workers;
+    for (int thread = 0; thread < options.threads; ++thread)
+      workers.emplace_back(work);
+    while (done < pending.size() && !interrupted) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{100});
+      const auto now = std::chrono::steady_clock::now();
+      if (now - lastReport < std::chrono::seconds{10})
+        continue;
+      lastReport = now;
+      const std::chrono::duration<double> elapsed = now - start;
+      const double rate = static_cast<double>(done) / elapsed.count();
+      std::cout << done << " of " << pending.size() << " positions searched, "
+                << std::fixed << std::setprecision(2) << rate
+                << " per second, " << std::setprecision(0)
+                << static_cast<double>(pending.size() - done) /
+                       std::max(rate, 1e-9) / 3600
+                << " hours left" << std::endl;
+    }
+    if (interrupted)
+      stopSource.request_stop();
+  }
+  if (error)
+    std::rethrow_exception(error);
+  return done == pending.size();
+}
+
+/**
+ * Backs the scores of the searched positions up to the start with negamax
+ * and turns every move into a record
+ * @param nodes
+ * @param evaluations
+ * @return
+ */
+std::vector<OpeningBook::Record>
+backUp(std::unordered_map<zobrist::Key, Node> &nodes,
+       const std::vector<Evaluation> &evaluations) {
+  std::vector<OpeningBook::Record> records;
+  for (const Evaluation &evaluation : evaluations) {
+    Node &node = nodes.at(evaluation.hash);
+    node.score = evaluation.score;
+    node.lines = 1;
+    if (evaluation.square >= 0)
+      records.push_back(
+          OpeningBook::record(node.position, evaluation.square, node.score, 1));
+  }
+  // children have more discs than their parents, so fewest discs go last
+  std::vector<Node *> inner;
+  for (auto &[hash, node] : nodes)
+    if (!node.edges.empty())
+      inner.push_back(&node);
+  std::ranges::sort(inner, {}, [](const Node *node) {
+    return node->position.emptyCount();
+  });
+  for (Node *node : inner) {
+    node->score = -std::numeric_limits<double>::infinity();
+    for (const Edge &edge : node->edges) {
+      const Node &child = nodes.at(edge.child);
+      const double score = edge.sameSide ? child.score : -child.score;
+      node->score = std::max(node->score, score);
+      node->lines += child.lines;
+      const auto games = static_cast<std::uint32_t>(std::min<std::uint64_t>(
+          child.lines, std::numeric_limits<std::uint32_t>::max()));
+      records.push_back(
+          OpeningBook::record(node->position, edge.square, score, games));
+    }
+  }
+  return records;
+}
+} // namespace
+
+int main(int argc, char *argv[]) try {
+  const Options options = parseOptions(argc, argv);
+  std::signal(SIGINT, signalHandler);
+  std::signal(SIGTERM, signalHandler);
+
+  std::vector<zobrist::Key> leaves;
+  std::unordered_map<zobrist::Key, Node> nodes =
+      collectPositions(options.plies, leaves);
+  std::vector<Evaluation> evaluations;
+  Checkpoint checkpoint{options, evaluations};
+  std::unordered_map<zobrist::Key, bool> searched;
+  for (const Evaluation &evaluation : evaluations)
+    searched[evaluation.hash] = true;
+  std::vector<zobrist::Key> pending;
+  for (const zobrist::Key leaf : leaves)
+    if (!searched.contains(leaf))
+      pending.push_back(leaf);
+  std::cout << nodes.size() << " positions, " << leaves.size()
+            << " to search, " << leaves.size() - pending.size()
+            << " of them in " << options.checkpoint << std::endl;
+
+  if (!searchLeaves(options, nodes, pending, checkpoint, evaluations)) {
+    std::cout << "Interrupted, run again with the same options to go on"
+              << std::endl;
+    return 1;
+  }
+  const std::vector<OpeningBook::Record> records = backUp(nodes, evaluations);
+  OpeningBook::write(options.output, records);
+  const Node &start = nodes.at(Othello{}.canonical().position.hash());
+  std::cout << "Wrote " << records.size() << " moves to " << options.output
+            << ", the start position scores " << start.score << std::endl;
+  return 0;
+} catch (...) {
+  std::cerr << boost::current_exception_diagnostic_information(true);
+  return -1;
+}
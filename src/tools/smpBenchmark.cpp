@@ -0,0 +1,152 @@
+/**
+ * othello_smp_benchmark: measures how much faster the parallel searches get
+ * to a fixed depth as threads are added.
+ *
+ * Every thread count searches the same midgame positions, each with a fresh
+ * transposition table, and the total time is compared to the time on one
+ * thread.
+ *
+ * Usage: othello_smp_benchmark [options]
+ *   --depth D          The depth to search each position to, 9 by default
+ *   --threads T        The most threads to try, one per core by default
+ *   --positions P      How many positions to search, 12 by default
+ *   --heuristic H      coin, mobility, stability or composite
+ *   --search S         lazy for LAZY_SMP, the default, or ybw for
+ *                      YOUNG_BROTHERS_WAIT, which also reports how it split
+ *                      the work
+ */
+#include "CommandLine.hpp"
+#include "MinMaxStrategy.hpp"
+#include "Othello.hpp"
+#include "compositeHeuristic.hpp"
+#include "heuristicByName.hpp"
+#include <algorithm>
+#include <boost/exception/diagnostic_information.hpp>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Options {
+  int depth = 9;
+  int threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  int positions = 12;
+  HeuristicFunction heuristic = compositeHeuristic;
+  MinMaxStrategy::Search search = MinMaxStrategy::Search::LAZY_SMP;
+};
+
+Options parseOptions(int argc, char *argv[]) {
+  const CommandLine commandLine{
+      argc, argv,
+      "Usage: othello_smp_benchmark [--depth D] [--threads T]"
+      " [--positions P] [--heuristic " +
+          std::string{heuristicNames} + "] [--search lazy|ybw]"};
+  Options options;
+  for (int i = 1; i < commandLine.size(); ++i) {
+    const std::string_view arg = commandLine[i];
+    if (arg == "--depth") {
+      options.depth = commandLine.positiveNumber(i);
+    } else if (arg == "--threads") {
+      options.threads = commandLine.positiveNumber(i);
+    } else if (arg == "--positions") {
+      options.positions = commandLine.positiveNumber(i);
+    } else if (arg == "--heuristic") {
+      options.heuristic = commandLine.heuristic(i);
+    } else if (arg == "--search") {
+      const std::string_view name = commandLine.value(i);
+      if (name == "lazy")
+        options.search = MinMaxStrategy::Search::LAZY_SMP;
+      else if (name == "ybw")
+        options.search = MinMaxStrategy::Search::YOUNG_BROTHERS_WAIT;
+      else
+        commandLine.usage("Unknown search " + std::string{name});
+    } else {
+      commandLine.usage("Unknown option " + std::string{arg});
+    }
+  }
+  return options;
+}
+
+/**
+ * Plays random openings of 10 to 30 moves, the same ones on every run
+ */
+std::vector<Othello> midgamePositions(int count) {
+  std::mt19937 generator{20240601};
+  std::vector<Othello> positions;
+  while (static_cast<int>(positions.size()) < count) {
+    Othello othello;
+    const int moves = std::uniform_int_distribution{10, 30}(generator);
+    for (int i = 0; i < moves && othello.legalMoveMask(); ++i) {
+      const Othello::LegalMoves legalMoves = othello.legalMoves();
+      const LegalMove &move = legalMoves[std::uniform_int_distribution{
+          0, legalMoves.size() - 1}(generator)];
+      othello.placePiece(move.x(), move.y());
+    }
+    if (othello.legalMoveMask())
+      positions.push_back(othello);
+  }
+  return positions;
+}
+} // namespace
+
+int main(int argc, char *argv[]) try {
+  const Options options = parseOptions(argc, argv);
+  const std::vector<Othello> positions = midgamePositions(options.positions);
+
+  std::vector<int> threadCounts;
+  for (int threads = 1; threads < options.threads; threads *= 2)
+    threadCounts.push_back(threads);
+  threadCounts.push_back(options.threads);
+
+  const bool youngBrothersWait =
+      options.search == MinMaxStrategy::Search::YOUNG_BROTHERS_WAIT;
+  std::cout << "threads" << std::setw(12) << "seconds" << std::setw(10)
+            << "speedup" << std::setw(14) << "nodes" << std::setw(13)
+            << "nodes/s";
+  if (youngBrothersWait)
+    std::cout << std::setw(10) << "splits" << std::setw(10) << "tasks"
+              << std::setw(10) << "steals" << std::setw(10) << "cutoffs";
+  std::cout << "\n";
+  double baseline = 0;
+  for (const int threads : threadCounts) {
+    double seconds = 0;
+    std::uint64_t nodes = 0;
+    MinMaxStrategy::SplitStats splitStats{};
+    for (const Othello &position : positions) {
+      MinMaxStrategy strategy{options.depth, options.search, threads};
+      const auto start = std::chrono::steady_clock::now();
+      strategy.nextMove(options.heuristic, position);
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      seconds += elapsed.count();
+      nodes += strategy.nodeCount();
+      splitStats.splits += strategy.splitStats().splits;
+      splitStats.tasks += strategy.splitStats().tasks;
+      splitStats.steals += strategy.splitStats().steals;
+      splitStats.cutoffs += strategy.splitStats().cutoffs;
+    }
+    if (threads == 1)
+      baseline = seconds;
+    std::cout << std::setw(7) << threads << std::setw(12) << std::fixed
+              << std::setprecision(3) << seconds << std::setw(10)
+              << std::setprecision(2) << baseline / seconds << std::setw(14)
+              << nodes << std::setw(13) << std::setprecision(0)
+              << nodes / seconds;
+    if (youngBrothersWait)
+      std::cout << std::setw(10) << splitStats.splits << std::setw(10)
+                << splitStats.tasks << std::setw(10) << splitStats.steals
+                << std::setw(10) << splitStats.cutoffs;
+    std::cout << std::endl;
+  }
+  return 0;
+} catch (...) {
+  std::cerr << boost::current_exception_diagnostic_information(true);
+  return -1;
+}
@@ -0,0 +1,50 @@
+#include "allocation_counter.hpp"
+
+#ifndef NDEBUG
+#include <cstdlib>
+#include <new>
+
+namespace {
+thread_local std::uint64_t allocations = 0;
+
+void *allocate(std::size_t size) {
+  ++allocations;
+  if (void *memory = std::malloc(size ? size : 1))
+    return memory;
+  throw std::bad_alloc{};
+}
+
+void *allocate(std::size_t size, std::align_val_t alignment) {
+  ++allocations;
+  const auto align = static_cast<std::size_t>(alignment);
+  // aligned_alloc wants a size that is a multiple of the alignment
+  const std::size_t rounded = (size + align - 1) / align * align;
+  if (void *memory = std::aligned_alloc(align, rounded ? rounded : align))
+    return memory;
+  throw std::bad_alloc{};
+}
+} // namespace
+
+// the other forms of new and delete end up in these
+void *operator new(std::size_t size) { return allocate(size); }
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return allocate(size, alignment);
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+  std::free(memory);
+}
+
+std::uint64_t util::threadAllocationCount() { return allocations; }
+#else
+std::uint64_t util::threadAllocationCount() { return 0; }
+#endif
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+namespace util {
+/**
+ * Lets code that must not allocate, such as the inner loops of a search,
+ * check that it does not
+ * @return The heap allocations made so far by the calling thread, always 0
+ * in release builds, which do not count them
+ */
+std::uint64_t threadAllocationCount();
+} // namespace util
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include <array>
+#include <cstdint>
+
+/**
+ * Random keys for Zobrist hashing: a position hashes to the XOR of the key
+ * of every disc on the board, plus a key when white is to move. Placing,
+ * flipping or passing then changes the hash with a couple of XORs.
+ *
+ * The keys are generated at compile time so every build hashes alike, which
+ * lets hashes be stored in files.
+ */
+namespace zobrist {
+using Key = std::uint64_t;
+
+namespace detail {
+constexpr Key splitMix64(Key &state) {
+  Key z = (state += 0x9E3779B97F4A7C15);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+
+template <int N> struct Keys {
+  std::array<Key, N * N> black;
+  std::array<Key, N * N> white;
+  Key whiteTurn;
+};
+
+template <int N> constexpr Keys<N> generateKeys() {
+  Keys<N> keys{};
+  Key state = 0x0123456789ABCDEF;
+  for (auto &key : keys.black)
+    key = splitMix64(state);
+  for (auto &key : keys.white)
+    key = splitMix64(state);
+  keys.whiteTurn = splitMix64(state);
+  return keys;
+}
+
+template <int N> inline constexpr Keys<N> keys = generateKeys<N>();
+} // namespace detail
+
+template <int N = bitboard::boardSize>
+constexpr Key disc(int square, bool isBlack) {
+  return isBlack ? detail::keys<N>.black[square]
+                 : detail::keys<N>.white[square];
+}
+
+/**
+ * @return The change in hash when the disc on the square changes color
+ */
+template <int N = bitboard::boardSize> constexpr Key flip(int square) {
+  return detail::keys<N>.black[square] ^ detail::keys<N>.white[square];
+}
+
+template <int N = bitboard::boardSize> constexpr Key whiteTurn() {
+  return detail::keys<N>.whiteTurn;
+}
+
+/**
+ * Hashes a position from scratch
+ */
+template <int N = bitboard::boardSize>
+constexpr Key hash(bitboard::BasicBitboard<N> black,
+                   bitboard::BasicBitboard<N> white, bool blackTurn) {
+  Key key = blackTurn ? 0 : whiteTurn<N>();
+  while (black)
+    key ^= disc<N>(bitboard::popSquare(black), true);
+  while (white)
+    key ^= disc<N>(bitboard::popSquare(white), false);
+  return key;
+}
+} // namespace zobrist